@@ -1,4 +1,7 @@
 #include "BassStyleDB.h"
+#include "BoomRandom.h"
+#include "PhrasePlanner.h"
+#include "WeightedSampler.h"
 #include <random>
 
 namespace boom {
@@ -145,5 +148,364 @@ namespace boom {
             return cells;
         }
 
+
+        // ===== Generator =====================================================
+
+        // Subdivision grids, in normalizedSubdivisionWeights() order, plus a few slot flags
+        enum SlotFlag : std::uint16_t
+        {
+            OnQuarter = 1 << 0,     // beat start
+            OnEighth = 1 << 1,
+            OnOffEighth = 1 << 2,
+            OnSixteenth = 1 << 3,
+            OnEighthTrip = 1 << 4,
+            OnSixteenthTrip = 1 << 5,
+            Dotted = 1 << 6,        // last 1/16 of a beat: where a dotted 8th lands
+            CellStart = 1 << 7,     // start of an odd-meter accent cell
+            Tresillo = 1 << 8       // 3-3-2 accent point
+        };
+
+        static constexpr int kNumGrids = 6;
+
+        // Per-style cumulative subdivision distributions, compiled once at load (index == allStyles() order)
+        static const std::vector<std::array<float, kNumGrids>> kStyleCdf = []
+        {
+            std::vector<std::array<float, kNumGrids>> out;
+            out.reserve(kStyles.size());
+            for (const auto& s : kStyles)
+            {
+                auto w = normalizedSubdivisionWeights(s);
+                for (int g = 1; g < kNumGrids; ++g) w[(size_t)g] += w[(size_t)g - 1];
+                out.push_back(w);
+            }
+            return out;
+        }();
+
+        // One bar of a meter on the slot grid: flags per slot and the slots of each subdivision.
+        // Built once per meter (see meterGrid) and shared by every generate() call and bar.
+        struct MeterGrid
+        {
+            int barTicks = 0;
+            int numSlots = 0;
+            bool evenBeats = true;                           // every beat is a quarter (swing applies)
+            std::uint16_t flags[kMaxSlotsPerBar] {};
+            std::uint8_t slots[kNumGrids][kMaxSlotsPerBar] {};
+            int count[kNumGrids] {};
+            std::uint8_t dotted[kMaxSlotsPerBar] {};
+            int numDotted = 0;
+        };
+
+        static void buildMeterGrid(int num, int den, MeterGrid& g)
+        {
+            if (den != 2 && den != 4 && den != 8 && den != 16) den = 4;
+            num = juce::jlimit(1, 32, num);
+            g.barTicks = num * (4 * kTicksPerQuarter / den);
+            g.numSlots = juce::jmin(kMaxSlotsPerBar, g.barTicks / kSlotTicks);
+
+            // Beats in ticks: quarters, half notes in x/2, accent cells (or dotted quarters) in x/8
+            std::vector<int> beats;
+            const auto cells = defaultAccentCellsForMeter(num, den);
+            if (den == 8)
+            {
+                int at = 0;
+                if (!cells.empty())
+                    for (int c : cells) { beats.push_back(at); at += c * 48; }
+                else
+                {
+                    const int cell = (num % 3 == 0) ? 3 : 2;
+                    for (int e = 0; e < num; e += cell) beats.push_back(e * 48);
+                }
+            }
+            else
+            {
+                const int beatTicks = den == 2 ? 2 * kTicksPerQuarter : kTicksPerQuarter;
+                for (int t = 0; t < g.barTicks; t += beatTicks) beats.push_back(t);
+            }
+            beats.push_back(g.barTicks);
+
+            for (size_t b = 0; b + 1 < beats.size(); ++b)
+                if (beats[b + 1] - beats[b] != kTicksPerQuarter) g.evenBeats = false;
+
+            size_t beat = 0;
+            for (int s = 0; s < g.numSlots; ++s)
+            {
+                const int t = s * kSlotTicks;
+                while (beat + 2 < beats.size() && beats[beat + 1] <= t) ++beat;
+                const int rel = t - beats[beat];
+                const int beatLen = beats[beat + 1] - beats[beat];
+
+                std::uint16_t f = 0;
+                if (rel == 0) f |= OnQuarter;
+                if (t % 48 == 0) f |= (rel == 0 ? OnEighth : (OnEighth | OnOffEighth));
+                if (t % 24 == 0) f |= OnSixteenth;
+                if (beatLen % 3 == 0 && rel % (beatLen / 3) == 0) f |= OnEighthTrip;
+                if (beatLen % 6 == 0 && rel % (beatLen / 6) == 0) f |= OnSixteenthTrip;
+                if (beatLen >= 72 && rel == beatLen - 24) f |= Dotted;
+                if (rel == 0 && !cells.empty()) f |= CellStart;
+                if (t % 48 == 0) { const int e = (t / 48) % 8; if (e == 0 || e == 3 || e == 6) f |= Tresillo; }
+                g.flags[s] = f;
+
+                for (int k = 0; k < kNumGrids; ++k)
+                    if (f & (1 << k)) g.slots[k][g.count[k]++] = (std::uint8_t)s;
+                if (f & Dotted) g.dotted[g.numDotted++] = (std::uint8_t)s;
+            }
+        }
+
+        // Every meter the generator accepts (num 1..32 over 2/4/8/16), built on first use; other
+        // denominators fall back to 4 as in buildMeterGrid
+        static const MeterGrid& meterGrid(int num, int den)
+        {
+            static constexpr int kDens[] = { 2, 4, 8, 16 };
+            static const std::vector<MeterGrid> table = []
+            {
+                std::vector<MeterGrid> t((size_t)(32 * 4));
+                for (int d = 0; d < 4; ++d)
+                    for (int n = 1; n <= 32; ++n)
+                        buildMeterGrid(n, kDens[d], t[(size_t)(d * 32 + n - 1)]);
+                return t;
+            }();
+
+            int d = 1;
+            for (int i = 0; i < 4; ++i)
+                if (kDens[i] == den) d = i;
+            return table[(size_t)(d * 32 + juce::jlimit(1, 32, num) - 1)];
+        }
+
+        // One bar of onsets, 128 slots in two words; the popcount is the hit budget
+        struct BarBits
+        {
+            std::uint64_t w[2] {};
+
+            bool test(int s) const noexcept { return (w[s >> 6] >> (s & 63)) & 1u; }
+            void set(int s) noexcept { w[s >> 6] |= 1ull << (s & 63); }
+            void clear(int s) noexcept { w[s >> 6] &= ~(1ull << (s & 63)); }
+            int count() const noexcept { return juce::countNumberOfBits((juce::uint64)w[0]) + juce::countNumberOfBits((juce::uint64)w[1]); }
+
+            // Slot s or a direct neighbour taken: onsets stay at least 16 ticks apart
+            bool crowded(int s) const noexcept { return test(s) || (s > 0 && test(s - 1)) || (s + 1 < kMaxSlotsPerBar && test(s + 1)); }
+
+            // Index of the k-th set slot (k < count())
+            int nth(int k) const noexcept
+            {
+                for (int i = 0; i < 2; ++i)
+                {
+                    std::uint64_t x = w[i];
+                    const int c = juce::countNumberOfBits((juce::uint64)x);
+                    if (k >= c) { k -= c; continue; }
+                    while (k-- > 0) x &= x - 1;
+                    int bit = 0;
+                    while (!((x >> bit) & 1u)) ++bit;
+                    return i * 64 + bit;
+                }
+                return -1;
+            }
+        };
+
+        void generate(const StyleSpec& spec, int bars, int numerator, int denominator,
+            int restPct, int dottedPct, int tripletPct, int swingPct,
+            int seed, BassPattern& out, const std::vector<float>* kickBias, float coupling,
+            const boom::PatternLocks* locks)
+        {
+            out.clearQuick();
+            bars = juce::jlimit(1, 128, bars);
+            auto barOpen = [locks](int bar) { return locks == nullptr || !locks->barLocked(bar); };
+
+            boom::Rng rng(static_cast<std::uint64_t>(static_cast<std::uint32_t>(seed)));
+
+            const float restF = juce::jlimit(0, 100, restPct) / 100.0f;
+            const float dottedF = juce::jlimit(0, 100, dottedPct) / 100.0f;
+            const float tripletF = juce::jlimit(0, 100, tripletPct) / 100.0f;
+            const float swingF = juce::jlimit(0, 100, swingPct) / 100.0f;
+            const float sync = juce::jlimit(0.0f, 1.0f, spec.syncopationProb);
+            coupling = (kickBias != nullptr && !kickBias->empty()) ? juce::jlimit(-1.0f, 1.0f, coupling) : 0.0f;
+
+            const MeterGrid& g = meterGrid(numerator, denominator);
+            const bool compound = (denominator == 8 && numerator % 3 == 0);
+
+            // Subdivision CDF: the style's compiled one, or computed here for a spec from elsewhere;
+            // the triplet slider and the meter then reshape it (still six entries)
+            std::array<float, kNumGrids> w {};
+            {
+                size_t idx = 0;
+                while (idx < kStyles.size() && &kStyles[idx] != &spec) ++idx;
+                std::array<float, kNumGrids> cdf {};
+                if (idx < kStyles.size()) cdf = kStyleCdf[idx];
+                else
+                {
+                    cdf = normalizedSubdivisionWeights(spec);
+                    for (int k = 1; k < kNumGrids; ++k) cdf[(size_t)k] += cdf[(size_t)k - 1];
+                }
+                for (int k = 0; k < kNumGrids; ++k) w[(size_t)k] = cdf[(size_t)k] - (k > 0 ? cdf[(size_t)k - 1] : 0.0f);
+            }
+            w[4] += 0.50f * tripletF;
+            w[5] += 0.25f * tripletF;
+            if (compound && !spec.prefersTripletMeters) { w[3] += w[4] + w[5]; w[4] = w[5] = 0.0f; }
+            float total = 0.0f;
+            for (int k = 0; k < kNumGrids; ++k)
+            {
+                if (g.count[k] == 0) w[(size_t)k] = 0.0f;
+                total += w[(size_t)k];
+                w[(size_t)k] = total;
+            }
+            if (total <= 0.0f) { w.fill(0.0f); for (int k = 1; k < kNumGrids; ++k) w[(size_t)k] = 1.0f; total = 1.0f; }
+
+            // Hit budget per bar (the style cap scales with bar length)
+            const float eighths = g.barTicks / 48.0f;
+            const int cap = spec.maxHitsPerBar > 0
+                ? juce::jmax(1, juce::roundToInt(spec.maxHitsPerBar * g.barTicks / (4.0f * kTicksPerQuarter)))
+                : g.numSlots;
+            const bool tresillo = spec.enforceTresillo && numerator == 4 && denominator == 4;
+            const bool cellAccents = spec.prefersCellAccents;
+
+            // Probability of each slot as one onset draw: a dotted landing now and then, otherwise a
+            // subdivision from the CDF and a slot of it; syncopation then pulls some beat onsets
+            // forward into an anticipation (an 8th or a 16th early). Same for every bar.
+            std::array<float, kMaxSlotsPerBar> slotWeight {};
+            {
+                const float pDotted = g.numDotted > 0 ? 0.3f * dottedF : 0.0f;
+                for (int i = 0; i < g.numDotted; ++i)
+                    slotWeight[g.dotted[i]] += pDotted / (float)g.numDotted;
+                for (int k = 0; k < kNumGrids; ++k)
+                {
+                    const float pk = (w[(size_t)k] - (k > 0 ? w[(size_t)k - 1] : 0.0f)) / total;
+                    for (int i = 0; i < g.count[k]; ++i)
+                        slotWeight[g.slots[k][i]] += (1.0f - pDotted) * pk / (float)g.count[k];
+                }
+                for (int s = 1; s < g.numSlots; ++s)
+                {
+                    if (!(g.flags[s] & OnQuarter) || sync <= 0.0f) continue;
+                    const float moved = slotWeight[(size_t)s] * sync;
+                    slotWeight[(size_t)s] -= moved;
+                    slotWeight[(size_t)juce::jmax(0, s - 48 / kSlotTicks)] += 0.5f * moved;
+                    slotWeight[(size_t)juce::jmax(0, s - 24 / kSlotTicks)] += 0.5f * moved;
+                }
+            }
+
+            // Kick coupling reweights a slot toward (or away from) the drum kick under it
+            auto couplingWeight = [&](int bar, int s) -> float
+            {
+                if (coupling == 0.0f) return 1.0f;
+                const size_t i16 = (size_t)((bar * g.barTicks + s * kSlotTicks) / 24);
+                const float kb = i16 < kickBias->size() ? (*kickBias)[i16] : 0.5f;
+                return (1.0f + coupling * (2.0f * kb - 1.0f)) / (1.0f + std::abs(coupling));
+            };
+
+            // Seed-stable: every bar, fill and note draws from its own stream (keyed by bar or
+            // tick), so a slider only changes what it acts on. More rest means fewer takes from
+            // the same sequence, i.e. a subset of the onsets.
+            const std::uint64_t barSalt = rng.next(), moveSalt = rng.next(), noteSalt = rng.next();
+
+            // Adds up to 'n' onsets within the budget, drawn without replacement over the bar's
+            // slots; a crowded slot is dropped when drawn. That is exact (each onset follows the
+            // weights of the slots still free) and the bar fills to the budget whenever a weighted
+            // free slot is left. Building over every slot, not just the free ones, keeps the draw
+            // sequence the same for the same stream, so a sparser take is a prefix of a busier one.
+            WeightedSampler<kMaxSlotsPerBar> sampler;
+            auto fill = [&](BarBits& b, int bar, int n, std::uint64_t salt)
+            {
+                const int want = juce::jmin(cap, b.count() + n);
+                if (b.count() >= want) return;
+
+                sampler.build(g.numSlots, [&](int s) { return slotWeight[(size_t)s] * couplingWeight(bar, s); });
+                boom::Rng ar(boom::splitmix64(salt));
+                while (b.count() < want)
+                {
+                    const int s = sampler.take(ar);
+                    if (s < 0) break;
+                    if (!b.crowded(s)) b.set(s);
+                }
+            };
+
+            auto freshBar = [&](int bar, int extra) -> BarBits
+            {
+                boom::Rng br(boom::splitmix64(barSalt + (std::uint64_t)bar));
+                BarBits b;
+                if (!br.chance(0.5f * sync)) b.set(0);
+                for (int s = 1; s < g.numSlots && b.count() < cap; ++s)
+                    if ((tresillo && (g.flags[s] & Tresillo)) || (cellAccents && (g.flags[s] & CellStart)))
+                        if (!b.crowded(s)) b.set(s);
+
+                const float rest = juce::jlimit(0.0f, 1.0f, br.uniform(spec.restDensityMin, spec.restDensityMax));
+                const int n = juce::jlimit(1, cap, juce::roundToInt((1.0f - rest) * eighths * (1.0f - restF)) + extra);
+                fill(b, bar, n - b.count(), br.next());
+                return b;
+            };
+
+            // Motif bar, repeated; small mutations every smallVarEveryBars, a fresh (busier) bar
+            // closing every bigVarEveryBars phrase
+            boom::phrase::Cadence cadence;
+            cadence.cellBars = 1;
+            cadence.smallMin = cadence.smallMax = spec.smallVarEveryBars;
+            cadence.phraseBars = spec.bigVarEveryBars;
+            std::vector<boom::phrase::Bar> plan;
+            boom::phrase::plan(cadence, bars, rng, plan);
+
+            std::vector<BarBits> barBits((size_t)bars);
+            const BarBits motif = freshBar(0, 0);
+            barBits[0] = motif;
+            for (int bar = 1; bar < bars; ++bar)
+            {
+                if (!barOpen(bar)) continue; // locked: never built (the motif bar always is, it's the source)
+                const auto moves = plan[(size_t)bar].moves;
+                if (moves & boom::phrase::Fill)
+                    barBits[(size_t)bar] = freshBar(bar, 1);
+                else
+                {
+                    BarBits b = motif;
+                    if ((moves & boom::phrase::Small) && b.count() > 1)
+                    {
+                        boom::Rng mr(boom::splitmix64(moveSalt + (std::uint64_t)bar));
+                        const int victim = b.nth(1 + mr.below(b.count() - 1)); // keep the first onset
+                        b.clear(victim);
+                        fill(b, bar, 1, mr.next());
+                    }
+                    barBits[(size_t)bar] = b;
+                }
+            }
+
+            // Swing delays the off-8ths: the style's own ratio (50 = straight) plus up to 12 ticks from the UI
+            const int swingTicks = g.evenBeats
+                ? juce::jmax(0, juce::roundToInt((spec.swingPct / 100.0f - 0.5f) * kTicksPerQuarter) + juce::roundToInt(12.0f * swingF))
+                : 0;
+
+            struct Onset { int tick; std::uint16_t flags; };
+            std::vector<Onset> onsets;
+            onsets.reserve((size_t)bars * 16);
+            for (int bar = 0; bar < bars; ++bar)
+            {
+                if (!barOpen(bar)) continue;
+                const auto& b = barBits[(size_t)bar];
+                for (int i = 0; i < 2; ++i)
+                    for (std::uint64_t x = b.w[i]; x != 0; x &= x - 1)
+                    {
+                        int bit = 0;
+                        while (!((x >> bit) & 1u)) ++bit;
+                        const int s = i * 64 + bit;
+                        onsets.push_back({ bar * g.barTicks + s * kSlotTicks, g.flags[s] });
+                    }
+            }
+
+            out.ensureStorageAllocated((int)onsets.size());
+            const int end = bars * g.barTicks;
+            for (size_t i = 0; i < onsets.size(); ++i)
+            {
+                const auto& o = onsets[i];
+                const int oBar = o.tick / g.barTicks;
+                int next = (i + 1 < onsets.size()) ? onsets[i + 1].tick : end;
+                if (oBar + 1 < bars && !barOpen(oBar + 1))
+                    next = juce::jmin(next, (oBar + 1) * g.barTicks); // the locked bar's notes start there
+                const int start = o.tick + ((o.flags & OnOffEighth) ? juce::jmin(swingTicks, juce::jmax(0, next - o.tick - 8)) : 0);
+
+                // Natural length for the grid the note came from, dotted now and then, never overlapping
+                boom::Rng nr(boom::splitmix64(noteSalt + (std::uint64_t)o.tick));
+                int len = (o.flags & (OnEighth | OnQuarter)) ? 48 : (o.flags & OnSixteenth) ? 24 : (o.flags & OnEighthTrip) ? 32 : 16;
+                if (nr.chance(0.25f * dottedF)) len = len * 3 / 2;
+                len = juce::jlimit(8, juce::jmax(8, next - start), len);
+
+                int vel = (o.flags & OnQuarter) ? 112 : (o.flags & (CellStart | Tresillo)) ? 108 : (o.flags & OnOffEighth) ? 100 : 92;
+                vel += nr.range(-6, 6);
+                out.add({ start, len, juce::jlimit(1, 127, vel) });
+            }
+        }
     }
 } // namespace boom::bass
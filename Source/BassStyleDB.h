@@ -1,6 +1,9 @@
 #pragma once
 #include <JuceHeader.h>
+#include <array>
+#include <cstdint>
 #include <vector>
+#include "PatternLocks.h"
 
 namespace boom {
     namespace bass
@@ -52,6 +55,36 @@ namespace boom {
         // If meter isnt odd or no special plan is needed, returns empty.
         std::vector<int>               defaultAccentCellsForMeter(int numerator, int denominator);
 
+        // ===== Generator =====
+        // Onsets sit on an 8-tick slot grid (96 PPQ): 1/16 (24), 1/8T (32) and 1/16T (16) all land
+        // exactly on it, and one bar of anything up to 21/8 fits in 128 slots (two uint64 words).
+        static constexpr int kTicksPerQuarter = 96;
+        static constexpr int kSlotTicks = 8;
+        static constexpr int kMaxSlotsPerBar = 128;
+
+        struct BassHit { int startTick; int lenTicks; int vel; };
+        using BassPattern = juce::Array<BassHit>;
+
+        // Fills 'out' with a rhythm for 'bars' bars of numerator/denominator, driven entirely by the
+        // style's subdivision weights, rest range, swing, hit cap, variation cadence and meter flags.
+        // kickBias (optional, one 0..1 value per 1/16 from the start) pulls onsets toward the drum
+        // kicks when coupling > 0 and away from them when < 0. Same seed => same rhythm, and with the
+        // same seed a feel slider only changes what it acts on (more rest keeps a subset of the onsets).
+        // Locks (optional, bars only): locked bars are never built and stay out of 'out'; notes
+        // before one end at its barline.
+        void generate(const StyleSpec& spec,
+            int bars,
+            int numerator, int denominator,
+            int restPct,        // 0..100, on top of the style's own rest range
+            int dottedPct,      // 0..100
+            int tripletPct,     // 0..100
+            int swingPct,       // 0..100, added to the style swing
+            int seed,
+            BassPattern& out,
+            const std::vector<float>* kickBias = nullptr,
+            float coupling = 0.0f,
+            const boom::PatternLocks* locks = nullptr);
+
     }
 } // namespace boom::bass
 
@@ -0,0 +1,138 @@
+#pragma once
+#include <JuceHeader.h>
+#include <cstdint>
+
+// BOOM's own PRNG: xoshiro256** seeded through splitmix64, plus integer/float helpers that are
+// fully specified here (no std:: distributions, whose output differs between standard libraries).
+// Same seed => same numbers on every compiler and platform, and the whole state is 32 bytes.
+namespace boom
+{
+    inline constexpr std::uint64_t splitmix64(std::uint64_t x) noexcept
+    {
+        x += 0x9E3779B97F4A7C15ull;
+        x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ull;
+        x = (x ^ (x >> 27)) * 0x94D049BB133111EBull;
+        return x ^ (x >> 31);
+    }
+
+    class Rng
+    {
+    public:
+        constexpr explicit Rng(std::uint64_t seed = 0) noexcept { setSeed(seed); }
+
+        constexpr void setSeed(std::uint64_t seed) noexcept
+        {
+            // splitmix64 sequence fills the state (never all-zero)
+            for (auto& w : s)
+            {
+                w = splitmix64(seed);
+                seed += 0x9E3779B97F4A7C15ull;
+            }
+        }
+
+        constexpr std::uint64_t next() noexcept
+        {
+            const std::uint64_t result = rotl(s[1] * 5, 7) * 9;
+            const std::uint64_t t = s[1] << 17;
+            s[2] ^= s[0];
+            s[3] ^= s[1];
+            s[1] ^= s[2];
+            s[0] ^= s[3];
+            s[2] ^= t;
+            s[3] = rotl(s[3], 45);
+            return result;
+        }
+
+        constexpr std::uint32_t nextU32() noexcept { return (std::uint32_t)(next() >> 32); }
+
+        // Uniform in [0, n), unbiased (Lemire's multiply-shift with rejection). n <= 0 gives 0.
+        constexpr int below(int n) noexcept
+        {
+            if (n <= 1) return 0;
+            const std::uint32_t range = (std::uint32_t)n;
+            std::uint64_t m = (std::uint64_t)nextU32() * range;
+            std::uint32_t low = (std::uint32_t)m;
+            if (low < range)
+            {
+                const std::uint32_t threshold = (std::uint32_t)(0u - range) % range;
+                while (low < threshold)
+                {
+                    m = (std::uint64_t)nextU32() * range;
+                    low = (std::uint32_t)m;
+                }
+            }
+            return (int)(m >> 32);
+        }
+
+        // Uniform in [0, n) for 64-bit n (rejection on the 2^64 mod n low values). n == 0 gives 0.
+        constexpr std::uint64_t below64(std::uint64_t n) noexcept
+        {
+            if (n <= 1) return 0;
+            const std::uint64_t threshold = (0ull - n) % n;
+            for (;;)
+            {
+                const std::uint64_t x = next();
+                if (x >= threshold) return x % n;
+            }
+        }
+
+        // Uniform in [lo, hi], both inclusive
+        constexpr int range(int lo, int hi) noexcept
+        {
+            if (hi < lo) { const int t = lo; lo = hi; hi = t; }
+            return lo + below(hi - lo + 1);
+        }
+
+        // [0, 1) from the top 24 / 53 bits
+        constexpr float  nextFloat() noexcept  { return (float)(next() >> 40) * (1.0f / 16777216.0f); }
+        constexpr double nextDouble() noexcept { return (double)(next() >> 11) * (1.0 / 9007199254740992.0); }
+        constexpr float  uniform(float a, float b) noexcept { return a + (b - a) * nextFloat(); }
+
+        constexpr bool nextBool() noexcept          { return (next() >> 63) != 0; }
+        constexpr bool chance(float p01) noexcept   { return nextFloat() < p01; }
+        constexpr bool chancePct(int pct) noexcept  { return below(100) < pct; }
+
+        // juce::Random-style spellings so call sites read the same as before
+        constexpr int nextInt(int n) noexcept { return below(n); }
+        int nextInt(juce::Range<int> r) noexcept { return r.getLength() > 0 ? r.getStart() + below(r.getLength()) : r.getStart(); }
+
+        // Advance 2^128 steps: non-overlapping streams for parallel work from one seed
+        constexpr void jump() noexcept
+        {
+            constexpr std::uint64_t J[] = { 0x180EC6D33CFD0ABAull, 0xD5A61266F0C9392Cull,
+                                            0xA9582618E03FC9AAull, 0x39ABDC4529B1661Cull };
+            std::uint64_t t[4] = { 0, 0, 0, 0 };
+            for (auto j : J)
+                for (int b = 0; b < 64; ++b)
+                {
+                    if (j & (1ull << b))
+                        for (int i = 0; i < 4; ++i) t[i] ^= s[i];
+                    next();
+                }
+            for (int i = 0; i < 4; ++i) s[i] = t[i];
+        }
+
+        // Child stream for a sub-task: this generator jumps ahead, the child keeps the old position
+        constexpr Rng split() noexcept
+        {
+            Rng child = *this;
+            jump();
+            return child;
+        }
+
+    private:
+        static constexpr std::uint64_t rotl(std::uint64_t x, int k) noexcept { return (x << k) | (x >> (64 - k)); }
+
+        std::uint64_t s[4] = { 0, 0, 0, 0 };
+    };
+
+    // Determinism check: these values are fixed by the algorithm, so every compiler must agree at build time
+    namespace detail
+    {
+        constexpr std::uint64_t rngGolden() { Rng r(42); r.next(); return r.next(); }
+        constexpr int rngGoldenRange() { Rng r(7); int acc = 0; for (int i = 0; i < 16; ++i) acc = acc * 3 + r.range(0, 9); return acc; }
+    }
+    static_assert(splitmix64(0) == 0xE220A8397B1DCDAFull, "splitmix64 reference value");
+    static_assert(detail::rngGolden() == 0x6104D9866D113A7Eull, "xoshiro256** output changed");
+    static_assert(detail::rngGoldenRange() == 129630707, "Rng::range output changed");
+}
@@ -0,0 +1,92 @@
+#pragma once
+#include <JuceHeader.h>
+#include <algorithm>
+#include <cstdint>
+#include <numeric>
+#include <vector>
+#include "GrooveMetrics.h"
+#include "Parallel.h"
+
+// Best-of-N generation: run a seeded generator N times across the cores, score every result with a
+// few groove measures and keep the top K. The generator must be pure (seed in, pattern out) so the
+// candidates can be built in parallel and any one of them rebuilt later from its seed.
+namespace boom::search
+{
+    // What a "good" groove looks like; each term scores 0..1 and the weights mix them
+    struct Targets
+    {
+        float density = 0.22f;          // hits per row-step over all rows
+        float syncopation = 0.30f;      // share of kick/snare/clap weight off the strong beats
+        float repetition = 0.70f;       // bar-to-bar similarity (1 = loops exactly)
+
+        float wDensity = 1.0f;
+        float wSyncopation = 1.0f;
+        float wBackbeat = 1.0f;         // snare/clap on 2 and 4 in every bar
+        float wRepetition = 1.0f;
+        float wKickAlign = 1.0f;        // kicks on the beat, or on the reference onsets when given
+    };
+
+    // 1 at the target, falling linearly to 0 at the far end of [0, 1]
+    inline float closeness(float value, float target) noexcept
+    {
+        const float span = juce::jmax(target, 1.0f - target, 1.0e-3f);
+        return juce::jlimit(0.0f, 1.0f, 1.0f - std::abs(value - target) / span);
+    }
+
+    // Weighted 0..1 score from the groove measures. 'reference' (optional, row 0) is what kicks
+    // should line up with, e.g. the bass.
+    inline float scoreGroove(const groove::Grid& g, const Targets& t, const groove::Grid* reference = nullptr)
+    {
+        const float wSum = t.wDensity + t.wSyncopation + t.wBackbeat + t.wRepetition + t.wKickAlign;
+        if (wSum <= 0.0f) return 0.0f;
+        return (t.wDensity * closeness(groove::totalDensity(g), t.density)
+              + t.wSyncopation * closeness(groove::syncopation(g), t.syncopation)
+              + t.wBackbeat * groove::backbeat(g)
+              + t.wRepetition * closeness(groove::repetition(g), t.repetition)
+              + t.wKickAlign * groove::kickAlignment(g, reference)) / wSum;
+    }
+
+    template <typename PatternType>
+    struct Candidate
+    {
+        int index = 0;      // position in the batch (the seed is derived from it)
+        int seed = 0;
+        float score = 0.0f;
+        PatternType pattern;
+    };
+
+    // Generates 'count' candidates in parallel and returns the best 'topK', best first.
+    // generate(seed, PatternType&) fills a pattern; score(const PatternType&) rates it; seedFor(i) gives
+    // candidate i its seed. Ties keep batch order, so the result is the same on any core count.
+    template <typename PatternType, typename SeedFor, typename Generate, typename Score>
+    inline std::vector<Candidate<PatternType>> bestOf(int count, int topK, SeedFor&& seedFor, Generate&& generate, Score&& score)
+    {
+        count = juce::jmax(0, count);
+        std::vector<Candidate<PatternType>> all((size_t)count);
+        for (int i = 0; i < count; ++i) { all[(size_t)i].index = i; all[(size_t)i].seed = seedFor(i); }
+
+        parallelFor(count, 8, [&](int begin, int end)
+        {
+            for (int i = begin; i < end; ++i)
+            {
+                auto& c = all[(size_t)i];
+                generate(c.seed, c.pattern);
+                c.score = score(c.pattern);
+            }
+        });
+
+        const int k = juce::jlimit(0, count, topK);
+        std::vector<int> order((size_t)count);
+        std::iota(order.begin(), order.end(), 0);
+        std::partial_sort(order.begin(), order.begin() + k, order.end(), [&](int a, int b)
+        {
+            const float sa = all[(size_t)a].score, sb = all[(size_t)b].score;
+            return sa != sb ? sa > sb : a < b;
+        });
+
+        std::vector<Candidate<PatternType>> best;
+        best.reserve((size_t)k);
+        for (int i = 0; i < k; ++i) best.push_back(std::move(all[(size_t)order[(size_t)i]]));
+        return best;
+    }
+}
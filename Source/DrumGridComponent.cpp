@@ -23,10 +23,15 @@ void DrumGridComponent::setTimeSignature(int num, int den) noexcept
 
 void DrumGridComponent::setBarsToDisplay(int bars) noexcept
 {
-    bars = juce::jlimit(1, 64, bars);
+    bars = juce::jlimit(1, 128, bars);
     if (barsToDisplay_ != bars)
     {
         barsToDisplay_ = bars;
+
+        // One cell per step of every displayed bar: new bars start empty, dropped ones go away
+        for (auto& row : cells) row.resize((size_t)totalSteps(), false);
+        nextCells.clear();
+
         resized();
         repaint();
     }
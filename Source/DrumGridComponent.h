@@ -7,8 +7,9 @@ class DrumGridComponent : public juce::Component
 {
 public:
     explicit DrumGridComponent(BoomAudioProcessor& p, int barsToShow = 4, int stepsPerBar_ = 16)
-        : proc(p), bars(barsToShow), stepsPerBar(stepsPerBar_)
+        : proc(p), stepsPerBar(stepsPerBar_)
     {
+        barsToDisplay_ = juce::jlimit(1, 128, barsToShow);
         setWantsKeyboardFocus(true);
         setMouseCursor(juce::MouseCursor::PointingHandCursor);
         setInterceptsMouseClicks(true, true);
@@ -50,19 +51,49 @@ public:
 
     // Push an existing drum pattern into the grid (marks cells true where notes exist).
     // Assumes: row field of Note is the drum row index; startTick quantized at 16th (24 ticks).
+    // Notes past the displayed bars are left out (not wrapped onto earlier ones).
     void setPattern(const BoomAudioProcessor::Pattern& pat)
     {
         clearGrid();
         for (const auto& n : pat)
         {
             if (n.row < 0 || n.row >= (int)cells.size()) continue;
-            const int step = (n.startTick / ticksPerStep) % totalSteps();
+            const int step = n.startTick / ticksPerStep;
             if (step >= 0 && step < totalSteps())
                 cells[(size_t)n.row][(size_t)step] = true;
         }
         repaint();
     }
 
+    // Same as setPattern, but only repaints what changed: one span per row, from its first to
+    // its last changed cell. Used for live regeneration, where a slider move flips a few cells.
+    void updatePattern(const BoomAudioProcessor::Pattern& pat)
+    {
+        const int R = (int)cells.size();
+        const int C = totalSteps();
+        nextCells.resize(cells.size());
+        for (auto& row : nextCells) row.assign((size_t)C, false);
+        for (const auto& n : pat)
+        {
+            if (n.row < 0 || n.row >= R) continue;
+            const int step = n.startTick / ticksPerStep;
+            if (step >= 0 && step < C)
+                nextCells[(size_t)n.row][(size_t)step] = true;
+        }
+
+        for (int row = 0; row < R; ++row)
+        {
+            const auto& was = cells[(size_t)row];
+            const auto& now = nextCells[(size_t)row];
+            int first = -1, last = -1;
+            for (int s = 0; s < C; ++s)
+                if (was[(size_t)s] != now[(size_t)s]) { if (first < 0) first = s; last = s; }
+            if (first >= 0)
+                repaint(cellArea(row, first).getUnion(cellArea(row, last)));
+        }
+        cells.swap(nextCells);
+    }
+
     // Read out the grid into a Pattern (all rows), for internal use.
     BoomAudioProcessor::Pattern getPatternAllRows() const
     {
@@ -221,6 +252,13 @@ public:
             g.setColour(rowEnabled[(size_t)row] ? juce::Colours::white : juce::Colours::grey);
             g.setFont(juce::Font(14.0f, juce::Font::bold));
             g.drawFittedText(name, juce::Rectangle<int>((int)r.getX() + 6, (int)rowY, (int)labelWf - 12, (int)cellH), juce::Justification::centredLeft, 1);
+
+            // Locked lane (kept by Generate)
+            if (proc.getLocks(boom::Engine::Drums).rowLocked(row))
+            {
+                g.setFont(juce::Font(11.0f, juce::Font::bold));
+                g.drawFittedText("LOCK", juce::Rectangle<int>((int)r.getX() + 6, (int)rowY, (int)labelWf - 12, (int)cellH), juce::Justification::centredRight, 1);
+            }
         }
 
         // Grid background
@@ -268,6 +306,19 @@ public:
                 }
             }
         }
+
+        // Locked bars (kept by Generate): shaded, with the same LOCK tag as a locked lane
+        const auto& locks = proc.getLocks(boom::Engine::Drums);
+        for (int bar = 0; bar < barsToDisplay_; ++bar)
+        {
+            if (!locks.barLocked(bar)) continue;
+            const juce::Rectangle<float> barR(gridX + bar * stepsPerBar * cellW, r.getY(), stepsPerBar * cellW, r.getHeight());
+            g.setColour(juce::Colours::black.withAlpha(0.25f));
+            g.fillRect(barR);
+            g.setColour(juce::Colours::white);
+            g.setFont(juce::Font(11.0f, juce::Font::bold));
+            g.drawFittedText("LOCK", barR.withHeight((float)headerH_).reduced(4.0f, 0.0f).toNearestInt(), juce::Justification::centredRight, 1);
+        }
     }
 
     void resized() override {}
@@ -281,6 +332,15 @@ public:
 
         if (h.onLabel)
         {
+            // Shift-click: lock / unlock the lane, so Generate re-rolls only the other rows
+            if (e.mods.isShiftDown())
+            {
+                const auto drums = boom::Engine::Drums;
+                proc.setRowLocked(drums, h.row, !proc.getLocks(drums).rowLocked(h.row));
+                repaint();
+                return;
+            }
+
             // Toggle row enabled/disabled
             const bool now = !(rowEnabled[(size_t)h.row]);
             rowEnabled[(size_t)h.row] = now;
@@ -288,6 +348,16 @@ public:
             return;
         }
 
+        // Shift-click on the top band of a bar (the bar ruler): lock / unlock the whole bar
+        if (e.mods.isShiftDown() && e.position.y < (float)headerH_)
+        {
+            const auto drums = boom::Engine::Drums;
+            const int bar = h.step / stepsPerBar;
+            proc.setBarLocked(drums, bar, !proc.getLocks(drums).barLocked(bar));
+            repaint();
+            return;
+        }
+
         // Start paint sweep on this row
         dragging = true;
         dragRow = h.row;
@@ -320,11 +390,11 @@ private:
 
     juce::StringArray rowNames;
     std::vector<std::vector<bool>> cells;   // [row][step]
+    std::vector<std::vector<bool>> nextCells; // updatePattern's scratch, kept to reuse its storage
     std::vector<bool> rowEnabled;
 
     const int stepsPerBar = 16;
     const int ticksPerStep = 24;
-    const int bars;
     bool dragging = false;
     int dragRow = -1;
     bool dragValue = false;
@@ -350,9 +420,20 @@ private:
         int step = -1;
     };
 
-    int totalSteps() const { return bars * stepsPerBar; }
+    int totalSteps() const { return barsToDisplay_ * stepsPerBar; }
     float labelWidth() const { return juce::jmax(120.0f, getWidth() * 0.12f); }
 
+    // Pixel area of one cell as paint() lays it out (plus a pixel for the outline)
+    juce::Rectangle<int> cellArea(int row, int step) const
+    {
+        auto r = getLocalBounds().toFloat();
+        const float gridX = r.getX() + labelWidth();
+        const float cellW = (r.getWidth() - labelWidth()) / (float)totalSteps();
+        const float cellH = r.getHeight() / (float)juce::jmax(1, (int)cells.size());
+        return juce::Rectangle<float>(gridX + step * cellW, r.getY() + row * cellH, cellW, cellH)
+            .getSmallestIntegerContainer().expanded(1);
+    }
+
     void clearGrid()
     {
         const int R = juce::jmax(1, rowNames.size());
@@ -0,0 +1,120 @@
+#pragma once
+#include <JuceHeader.h>
+#include <cstdint>
+#include <type_traits>
+#include <vector>
+#include "DrumStyles.h"
+
+// Additive merge for Slapsmith: overlay a generated pattern onto the user's drums without touching
+// what is already there. Occupancy is one uint64 per (bar, row) on the generator's 6-tick slot grid,
+// so "is this a gap", "is it locked" and "how many hits does this row have" are bit tests and
+// popcounts. One pass over the base notes builds the maps, one pass over the generated notes decides.
+namespace boom::drums
+{
+    struct MergeRules
+    {
+        int   maxAddedPerBar = 4;        // new notes per row per bar
+        float maxGrowth = 1.0f;          // ...and at most this fraction of the row's existing hits (min 1)
+        int   maxHitsPerBar[NumRows] {}; // absolute per-row ceiling after the merge; 0 = none
+        int   gapSlots = 2;              // keep new notes this many slots (6 ticks each) off existing ones
+        float ghostVelScale = 0.6f;      // added notes sit under the backbone
+        int   ghostVelMax = 80;
+    };
+
+    // One uint64 per (bar, row): set bits are slots the user has locked. Nothing is added there.
+    using LockMask = std::vector<std::uint64_t>;
+
+    // Adds to 'base' (in place) the notes of 'extra' that land in gaps, skipping locked slots and
+    // respecting the per-row caps. Existing notes are never moved or removed; the additions are
+    // merged in by startTick, so a base in time order stays in time order. Returns the number of
+    // notes added. NoteArray is the processor's pattern (row/startTick/lengthTicks/velocity).
+    template <typename NoteArray>
+    int mergeEmbellishments(NoteArray& base, const DrumPattern& extra, int bars,
+                            const MergeRules& rules, const LockMask* locks = nullptr)
+    {
+        constexpr int barTicks = kSlotsPerBar * kSlotTicks;
+        bars = juce::jmax(1, bars);
+        const size_t cells = (size_t)bars * NumRows;
+
+        std::vector<std::uint64_t> occupied(cells, 0), blocked(cells, 0);
+        std::vector<std::uint8_t> added(cells, 0);
+
+        auto cellOf = [&](int row, int tick, int& slot) -> long
+        {
+            if (row < 0 || row >= NumRows || tick < 0) return -1;
+            const int bar = tick / barTicks;
+            if (bar >= bars) return -1;
+            slot = (tick % barTicks) / kSlotTicks;
+            return (long)bar * NumRows + row;
+        };
+
+        // Spread a slot bit over its neighbourhood (within the bar word)
+        auto around = [&](int slot) -> std::uint64_t
+        {
+            std::uint64_t m = 1ull << slot;
+            for (int d = 1; d <= rules.gapSlots; ++d)
+            {
+                if (slot + d < kSlotsPerBar) m |= 1ull << (slot + d);
+                if (slot - d >= 0)           m |= 1ull << (slot - d);
+            }
+            return m;
+        };
+
+        // Pass 1: existing notes -> occupancy and the gap mask
+        for (const auto& n : base)
+        {
+            int slot = 0;
+            const long c = cellOf(n.row, n.startTick, slot);
+            if (c < 0) continue;
+            occupied[(size_t)c] |= 1ull << slot;
+            blocked[(size_t)c] |= around(slot);
+        }
+
+        if (locks != nullptr)
+            for (size_t c = 0; c < cells && c < locks->size(); ++c)
+                blocked[c] |= (*locks)[c];
+
+        // Pass 2: generated notes -> accept the ones in gaps, under the caps
+        NoteArray accepted;
+        for (const auto& e : extra)
+        {
+            int slot = 0;
+            const long c = cellOf(e.row, e.startTick, slot);
+            if (c < 0) continue;
+            auto& occ = occupied[(size_t)c];
+            auto& blk = blocked[(size_t)c];
+            if ((blk >> slot) & 1u) continue;
+
+            const int have = juce::countNumberOfBits((juce::uint64)occ) - added[(size_t)c];
+            const int growCap = juce::jmax(1, (int)(have * rules.maxGrowth));
+            if (added[(size_t)c] >= juce::jmin(rules.maxAddedPerBar, growCap)) continue;
+            const int ceiling = rules.maxHitsPerBar[e.row];
+            if (ceiling > 0 && juce::countNumberOfBits((juce::uint64)occ) >= ceiling) continue;
+
+            std::decay_t<decltype(base.getReference(0))> n {};
+            n.row = e.row;
+            n.startTick = e.startTick;
+            n.lengthTicks = e.lenTicks;
+            n.velocity = juce::jlimit(1, rules.ghostVelMax, juce::roundToInt(e.vel * rules.ghostVelScale));
+            accepted.add(n);
+
+            occ |= 1ull << slot;
+            blk |= around(slot);
+            ++added[(size_t)c];
+        }
+
+        // Pass 3: merge the additions in from the back (the generator emits them in time order)
+        const int count = accepted.size();
+        if (count == 0) return 0;
+        int i = base.size() - 1, j = count - 1;
+        base.resize(base.size() + count);
+        for (int k = base.size() - 1; j >= 0; --k)
+        {
+            if (i >= 0 && base.getReference(i).startTick > accepted.getReference(j).startTick)
+                base.getReference(k) = base.getReference(i--);
+            else
+                base.getReference(k) = accepted.getReference(j--);
+        }
+        return count;
+    }
+}
@@ -1,6 +1,18 @@
 #include "DrumStyles.h"
-#include <random>
+#include "BoomRandom.h"
+#include "EngineDefs.h"
+#include "PhrasePlanner.h"
+#include <algorithm>
+#include <array>
 #include <cstdint>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+ #include <emmintrin.h>
+ #define BOOM_DRUMS_SSE2 1
+#endif
 
 namespace boom {
     namespace drums
@@ -232,47 +244,220 @@ namespace boom {
             return s;
         }
 
-        const juce::StringArray styleNames()
+        // ====== COMPILED TABLE =====================================================
+        // Rules shared by every style, applied while compiling the table
+        static DrumStyleSpec compiled(DrumStyleSpec s)
+        {
+            // One hi-hat can't be open and closed at once: the open hat yields to a closed hit in its slot
+            s.rows[OpenHat].avoidRow = ClosedHat;
+
+            // Variation cadence from the style rules (styles without their own rules get the pop ones)
+            const StyleRules& rules = boom::rulesForStyle(s.name);
+            s.varyEveryBarsMin = rules.varyEveryBarsMin;
+            s.varyEveryBarsMax = juce::jmax(rules.varyEveryBarsMin, rules.varyEveryBarsMax);
+            return s;
+        }
+
+        // Built once at load; generation only ever indexes it. Order must match StyleId.
+        static const std::array<DrumStyleSpec, kNumStyles> kSpecs {
+            compiled(makeTrap()), compiled(makeDrill()), compiled(makeEDM()), compiled(makeReggaeton()), compiled(makeRNB()),
+            compiled(makePop()), compiled(makeRock()), compiled(makeWxstie()), compiled(makeHipHop())
+        };
+
+        static constexpr const char* kNames[kNumStyles] = {
+            "trap","drill","edm","reggaeton","r&b","pop","rock","wxstie","hip hop"
+        };
+
+        const juce::StringArray& styleNames()
+        {
+            static const juce::StringArray names(kNames, kNumStyles);
+            return names;
+        }
+
+        const char* styleName(StyleId id) noexcept
+        {
+            return kNames[juce::jlimit(0, kNumStyles - 1, (int)id)];
+        }
+
+        bool findStyle(const juce::String& name, StyleId& out)
         {
-            return { "trap","drill","edm","reggaeton","r&b","pop","rock","wxstie","hip hop" };
+            const auto n = name.trim();
+            for (int i = 0; i < kNumStyles; ++i)
+                if (n.equalsIgnoreCase(kNames[i])) { out = (StyleId)i; return true; }
+            return false;
         }
 
-        DrumStyleSpec getSpec(const juce::String& styleName)
+        StyleId styleFromName(const juce::String& name, StyleId fallback)
         {
-            const auto name = styleName.trim().toLowerCase();
-            if (name == "trap")      return makeTrap();
-            if (name == "drill")     return makeDrill();
-            if (name == "edm")       return makeEDM();
-            if (name == "reggaeton") return makeReggaeton();
-            if (name == "r&b")       return makeRNB();
-            if (name == "pop")       return makePop();
-            if (name == "rock")      return makeRock();
-            if (name == "wxstie")    return makeWxstie();
-            if (name == "hip hop")   return makeHipHop();
-            // default
-            return makeHipHop();
+            StyleId id = fallback;
+            findStyle(name, id);
+            return id;
+        }
+
+        StyleId styleFromIndex(int index) noexcept
+        {
+            return (StyleId)juce::jlimit(0, kNumStyles - 1, index);
+        }
+
+        const DrumStyleSpec& getSpec(StyleId id) noexcept
+        {
+            return kSpecs[(size_t)juce::jlimit(0, kNumStyles - 1, (int)id)];
+        }
+
+        // === Style blending =========================================================
+
+        // out = a + (b - a) * t for one row's 16 step probabilities (4 lanes at a time on SSE2;
+        // the scalar path does the same operations, so both give identical results)
+        static void lerpSteps(const float* a, const float* b, float t, float* out) noexcept
+        {
+        #if BOOM_DRUMS_SSE2
+            const __m128 vt = _mm_set1_ps(t);
+            for (int i = 0; i < kStepsPerBar; i += 4)
+            {
+                const __m128 va = _mm_loadu_ps(a + i);
+                const __m128 vb = _mm_loadu_ps(b + i);
+                _mm_storeu_ps(out + i, _mm_add_ps(va, _mm_mul_ps(_mm_sub_ps(vb, va), vt)));
+            }
+        #else
+            for (int i = 0; i < kStepsPerBar; ++i)
+                out[i] = lerp(a[i], b[i], t);
+        #endif
+        }
+
+        static int lerpInt(int a, int b, float t) { return juce::roundToInt(lerp((float)a, (float)b, t)); }
+
+        DrumStyleSpec blendSpecs(const DrumStyleSpec& a, const DrumStyleSpec& b, float t)
+        {
+            t = juce::jlimit(0.0f, 1.0f, t);
+
+            // Discrete choices (name, backbeat lock, roll rate, occupancy rules) come from the nearer style
+            DrumStyleSpec s = (t < 0.5f) ? a : b;
+
+            s.swingPct = lerp(a.swingPct, b.swingPct, t);
+            s.tripletBias = lerp(a.tripletBias, b.tripletBias, t);
+            s.dottedBias = lerp(a.dottedBias, b.dottedBias, t);
+            s.bpmMin = lerpInt(a.bpmMin, b.bpmMin, t);
+            s.bpmMax = lerpInt(a.bpmMax, b.bpmMax, t);
+
+            for (int r = 0; r < NumRows; ++r)
+            {
+                const RowSpec& ra = a.rows[r];
+                const RowSpec& rb = b.rows[r];
+                RowSpec& ro = s.rows[r];
+
+                lerpSteps(ra.p, rb.p, t, ro.p);
+                ro.velMin = lerpInt(ra.velMin, rb.velMin, t);
+                ro.velMax = juce::jmax(ro.velMin, lerpInt(ra.velMax, rb.velMax, t));
+                ro.rollProb = lerp(ra.rollProb, rb.rollProb, t);
+                ro.timingJitterTicks = lerpInt(ra.timingJitterTicks, rb.timingJitterTicks, t);
+                ro.lenTicks = lerpInt(ra.lenTicks, rb.lenTicks, t);
+                if (ra.maxHitsPerBar > 0 && rb.maxHitsPerBar > 0)
+                    ro.maxHitsPerBar = lerpInt(ra.maxHitsPerBar, rb.maxHitsPerBar, t);
+            }
+            return s;
+        }
+
+        // Recent blends, direct-mapped on (pair, step): one full sweep of a pair (kBlendSteps + 1
+        // consecutive keys) fits without evicting itself.
+        struct BlendSlot
+        {
+            int key = -1;
+            DrumStyleSpec spec;
+        };
+
+        static constexpr int kBlendCacheSize = 64;
+        static_assert(kBlendCacheSize > kBlendSteps, "a full blend sweep must fit in the cache");
+
+        static std::array<BlendSlot, kBlendCacheSize> blendCache;
+        static juce::SpinLock blendCacheLock;
+
+        DrumStyleSpec blendedSpec(StyleId a, StyleId b, float weightB)
+        {
+            int ia = juce::jlimit(0, kNumStyles - 1, (int)a);
+            int ib = juce::jlimit(0, kNumStyles - 1, (int)b);
+            int step = juce::roundToInt(juce::jlimit(0.0f, 1.0f, weightB) * kBlendSteps);
+
+            // (a, b, w) and (b, a, 1 - w) are the same blend: keep the lower id first
+            if (ib < ia) { std::swap(ia, ib); step = kBlendSteps - step; }
+            if (ia == ib || step == 0) return kSpecs[(size_t)ia];
+            if (step == kBlendSteps)   return kSpecs[(size_t)ib];
+
+            const int key = (ia * kNumStyles + ib) * (kBlendSteps + 1) + step;
+            auto& slot = blendCache[(size_t)(key % kBlendCacheSize)];
+            {
+                const juce::SpinLock::ScopedLockType lock(blendCacheLock);
+                if (slot.key == key) return slot.spec;
+            }
+
+            const DrumStyleSpec spec = blendSpecs(kSpecs[(size_t)ia], kSpecs[(size_t)ib], step / (float)kBlendSteps);
+            const juce::SpinLock::ScopedLockType lock(blendCacheLock);
+            slot.key = key;
+            slot.spec = spec;
+            return spec;
         }
 
         // === Generator =============================================================
 
-        static int randRange(std::mt19937& rng, int a, int b) // inclusive
+        static int randRange(boom::Rng& rng, int a, int b) // inclusive
         {
-            std::uniform_int_distribution<int> d(a, b); return d(rng);
+            return rng.range(a, b);
         }
-        static float rand01(std::mt19937& rng)
+        static float rand01(boom::Rng& rng)
         {
-            std::uniform_real_distribution<float> d(0.0f, 1.0f); return d(rng);
+            return rng.nextFloat();
         }
 
-        void generate(const DrumStyleSpec& spec, int bars,
+        // Hit test in 24-bit fixed point: u < thr  <=>  rand01() <= p, with u the same top 24 bits
+        // nextFloat() uses. p <= 0 never hits, p >= 1 always does.
+        static constexpr std::uint32_t kUnit24 = 1u << 24;
+
+        static std::uint32_t threshold24(float p)
+        {
+            if (p <= 0.0f) return 0;
+            return (std::uint32_t)juce::jmin((double)kUnit24, std::floor((double)p * kUnit24) + 1.0);
+        }
+
+        // n 24-bit uniforms, two per 64-bit draw
+        static void fillUniform24(boom::Rng& rng, std::uint32_t* u, int n)
+        {
+            int i = 0;
+            for (; i + 1 < n; i += 2)
+            {
+                const std::uint64_t x = rng.next();
+                u[i] = (std::uint32_t)(x >> 40);
+                u[i + 1] = (std::uint32_t)(x >> 8) & (kUnit24 - 1);
+            }
+            if (i < n) u[i] = (std::uint32_t)(rng.next() >> 40);
+        }
+
+        // Bit s set where u[s] < thr[s], for one bar's 16 steps (4 compares of 4 lanes on SSE2)
+        static std::uint32_t hitMask16(const std::uint32_t* u, const std::uint32_t* thr)
+        {
+        #if BOOM_DRUMS_SSE2
+            std::uint32_t mask = 0;
+            for (int q = 0; q < kStepsPerBar / 4; ++q)
+            {
+                const __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(u + 4 * q));
+                const __m128i t = _mm_loadu_si128(reinterpret_cast<const __m128i*>(thr + 4 * q));
+                // Values fit in 25 bits, so the signed compare is exact
+                mask |= (std::uint32_t)_mm_movemask_ps(_mm_castsi128_ps(_mm_cmplt_epi32(a, t))) << (4 * q);
+            }
+            return mask;
+        #else
+            std::uint32_t mask = 0;
+            for (int s = 0; s < kStepsPerBar; ++s)
+                mask |= (std::uint32_t)(u[s] < thr[s]) << s;
+            return mask;
+        #endif
+        }
+
+        // Every bar generated in full from the spec (the phrase cell, and the alternate take).
+        // Only the rows in 'rowMask' are drawn and placed; the others stay empty.
+        static void generateBars(const DrumStyleSpec& spec, int bars,
             int restPct, int dottedPct, int tripletPct, int swingPct,
-            int seed, DrumPattern& out)
+            boom::Rng& rng, DrumPattern& out, std::uint32_t rowMask)
         {
             out.clearQuick();
-            bars = juce::jlimit(1, 16, bars);
-
-            std::mt19937 rng(static_cast<std::uint32_t>(
-                seed == -1 ? juce::Time::getMillisecondCounter() : seed));
 
             // Normalize user/global biases
             const float restBias = clamp01i(restPct) / 100.0f;
@@ -283,85 +468,324 @@ namespace boom {
 
             const int  ticksPer16 = 24;
             const int  barTicks = ticksPer16 * kStepsPerBar;
+            static_assert(kSlotTicks * kSlotsPerBar == 24 * kStepsPerBar, "one occupancy word per bar");
+
+            // Per-row, per-bar occupancy (bit = 6-tick slot) plus the hit stored in each set slot.
+            // Duplicates, backbeat checks, caps and collisions are bit tests; the output is then
+            // emitted slot by slot, i.e. already sorted by time.
+            struct Cell { int tick, len, vel; };
+            std::vector<std::uint64_t> occ((size_t)bars * NumRows, 0);
+            std::unique_ptr<Cell[]> cells(new Cell[(size_t)bars * NumRows * kSlotsPerBar]); // only read where a bit is set
+            auto occAt = [&](int bar, int row) -> std::uint64_t& { return occ[(size_t)bar * NumRows + (size_t)row]; };
+
+            auto place = [&](int bar, int row, int tick, int len, int vel)
+            {
+                const int slot = (tick - bar * barTicks) / kSlotTicks;
+                if (slot < 0 || slot >= kSlotsPerBar) return;
+                const std::uint64_t bit = 1ull << slot;
+                const RowSpec& rs = spec.rows[row];
+
+                std::uint64_t& mask = occAt(bar, row);
+                if (mask & bit) return;                                                   // same slot twice (stacked rolls)
+                if (rs.maxHitsPerBar > 0 && juce::countNumberOfBits((juce::uint64)mask) >= rs.maxHitsPerBar) return;
+                if (rs.avoidRow >= 0 && rs.avoidRow < NumRows && (occAt(bar, rs.avoidRow) & bit)) return;
+
+                mask |= bit;
+                cells[((size_t)bar * NumRows + (size_t)row) * kSlotsPerBar + (size_t)slot] = { tick, len, vel };
+            };
+
+            // Per-row step thresholds: the row's 16 probabilities after dotted / triplet / rest
+            // adjustment, computed once (they don't depend on the bar)
+            std::uint32_t thr[NumRows][kStepsPerBar];
+            for (int row = 0; row < NumRows; ++row)
+                for (int step = 0; step < kStepsPerBar; ++step)
+                {
+                    // Base probability
+                    float p = spec.rows[row].p[step];
+
+                    // Apply global dotted/triplet pushes:
+                    // If step falls on dotted (3/8 spacing -> steps 3,7,11,15) give it a nudge.
+                    if (dottedFeel > 0.0f && (step % 4) == 3)
+                        p = juce::jmin(1.0f, p + 0.35f * dottedFeel);
+                    // For triplet: nudge steps near 1/12 divisions (approx by giving odd 1/8-positions a bump)
+                    if (tripletFeel > 0.0f && (step % 2 == 1))
+                        p = juce::jmin(1.0f, p + 0.25f * tripletFeel);
+
+                    // Rest density pulls probability down
+                    thr[row][step] = threshold24(p * (1.0f - restBias));
+                }
 
-            // For each bar + row + step: Bernoulli on row probability -> create hit
+            // Bernoulli for every (row, bar, step) up front: one block of uniforms per row from the
+            // row's own stream (so skipping a locked row shifts nothing), compared 16 steps at a
+            // time into hit masks
+            const std::uint64_t rowSalt = rng.next();
+            std::vector<std::uint32_t> hitMask((size_t)bars * NumRows, 0);
+            std::vector<std::uint32_t> uni((size_t)bars * kStepsPerBar);
+            for (int row = 0; row < NumRows; ++row)
+            {
+                if (((rowMask >> row) & 1u) == 0) continue;
+                boom::Rng rr(boom::splitmix64(rowSalt + (std::uint64_t)row));
+                fillUniform24(rr, uni.data(), (int)uni.size());
+                for (int bar = 0; bar < bars; ++bar)
+                    hitMask[(size_t)bar * NumRows + (size_t)row] = hitMask16(uni.data() + (size_t)bar * kStepsPerBar, thr[row]);
+            }
+
+            // Seed-stable: the draws above don't depend on the feel sliders, and everything a hit
+            // draws (velocity, roll) comes from its own stream keyed by (bar, row, step). Moving a
+            // slider only adds or removes the hits whose threshold it crosses; the rest keep their
+            // values, and the caller's stream continues from the same position.
+            const std::uint64_t hitSalt = rng.next();
+            auto hitRng = [hitSalt](int bar, int row, int step)
+            {
+                return boom::Rng(boom::splitmix64(hitSalt + (std::uint64_t)((bar * NumRows + row) * (kStepsPerBar + 1) + step)));
+            };
+
+            // Hits -> notes (velocity, swing, rolls), bar by bar
             for (int bar = 0; bar < bars; ++bar)
             {
                 for (int row = 0; row < NumRows; ++row)
                 {
                     const RowSpec& rs = spec.rows[row];
 
-                    for (int step = 0; step < kStepsPerBar; ++step)
+                    for (std::uint32_t mask = hitMask[(size_t)bar * NumRows + (size_t)row]; mask != 0; mask &= mask - 1)
                     {
-                        // Base probability
-                        float p = rs.p[step];
+                        int step = 0;
+                        while (((mask >> step) & 1u) == 0) ++step;
 
-                        // Apply global dotted/triplet pushes:
-                        // If step falls on dotted (3/8 spacing -> steps 3,7,11,15) give it a nudge.
-                        if (dottedFeel > 0.0f)
-                        {
-                            const bool dottedPos = (step % 4) == 3;
-                            if (dottedPos) p = juce::jmin(1.0f, p + 0.35f * dottedFeel);
-                        }
-                        // For triplet: nudge steps near 1/12 divisions (approx by giving odd 1/8-positions a bump)
-                        if (tripletFeel > 0.0f && (step % 2 == 1))
-                            p = juce::jmin(1.0f, p + 0.25f * tripletFeel);
+                        // Spawn a hit
+                        auto hr = hitRng(bar, row, step);
+                        int vel = randRange(hr, rs.velMin, rs.velMax);
 
-                        // Rest density pulls probability down
-                        p *= (1.0f - restBias);
+                        // Basic swing on even 8th offbeats for hats/perc/openhat
+                        int startTick = bar * barTicks + step * ticksPer16;
 
-                        if (rand01(rng) <= p)
+                        if ((row == ClosedHat || row == OpenHat || row == Perc) && (step % 2 == 1))
                         {
-                            // Spawn a hit
-                            int vel = randRange(rng, rs.velMin, rs.velMax);
-
-                            // Basic swing on even 8th offbeats for hats/perc/openhat
-                            int startTick = bar * barTicks + step * ticksPer16;
-
-                            if ((row == ClosedHat || row == OpenHat || row == Perc) && (step % 2 == 1))
-                            {
-                                int swingTicks = (int)std::round((ticksPer16 * 0.5f) * swingAsFrac); // swing 8ths by up to 50% of a 16th
-                                startTick += swingTicks;
-                            }
+                            int swingTicks = (int)std::round((ticksPer16 * 0.5f) * swingAsFrac); // swing 8ths by up to 50% of a 16th
+                            startTick += swingTicks;
+                        }
 
-                            int len = rs.lenTicks;
+                        int len = rs.lenTicks;
 
-                            // Occasional micro-rolls (esp. hats)
-                            if (rs.rollProb > 0.0f && rand01(rng) < rs.rollProb && rs.maxRollSub > 1)
-                            {
-                                // Choose sub = 2 (32nds) or 3 (triplets at ~ 1/24th multiples)
-                                const int sub = juce::jlimit(2, rs.maxRollSub, randRange(rng, 2, rs.maxRollSub));
-                                const int divTicks = (sub == 2 ? ticksPer16 / 2 : 16); // 12th-of-bar ? 8 ticks; we’ll use 16 ticks ~ triplet-ish
-                                const int hits = randRange(rng, 2, 4);
-                                for (int r = 0; r < hits; ++r)
-                                {
-                                    int st = startTick + r * divTicks;
-                                    if (st < (bar + 1) * barTicks)
-                                        out.add({ row, st, juce::jmax(12, len - 4 * r), juce::jlimit(40,127, vel - 3 * r) });
-                                }
-                            }
-                            else
+                        // Occasional micro-rolls (esp. hats)
+                        if (rs.rollProb > 0.0f && rand01(hr) < rs.rollProb && rs.maxRollSub > 1)
+                        {
+                            // Choose sub = 2 (32nds) or 3 (triplets at ~ 1/24th multiples)
+                            const int sub = juce::jlimit(2, rs.maxRollSub, randRange(hr, 2, rs.maxRollSub));
+                            const int divTicks = (sub == 2 ? ticksPer16 / 2 : 16); // 12th-of-bar ? 8 ticks; we’ll use 16 ticks ~ triplet-ish
+                            const int hits = randRange(hr, 2, 4);
+                            for (int r = 0; r < hits; ++r)
                             {
-                                out.add({ row, startTick, len, vel });
+                                int st = startTick + r * divTicks;
+                                if (st < (bar + 1) * barTicks)
+                                    place(bar, row, st, juce::jmax(12, len - 4 * r), juce::jlimit(40,127, vel - 3 * r));
                             }
                         }
+                        else
+                        {
+                            place(bar, row, startTick, len, vel);
+                        }
                     }
 
                     // Lock backbeat if requested (ensure at least one snare/clap on 2 & 4)
-                    if (spec.lockBackbeat && (row == Snare || row == Clap))
+                    if (spec.lockBackbeat && (row == Snare || row == Clap) && ((rowMask >> row) & 1u) != 0)
                     {
                         const int b2 = bar * barTicks + 4 * ticksPer16;
                         const int b4 = bar * barTicks + 12 * ticksPer16;
+                        const std::uint64_t mask = occAt(bar, row);
+                        const bool has2 = (mask >> (4 * ticksPer16 / kSlotTicks)) & 1u;
+                        const bool has4 = (mask >> (12 * ticksPer16 / kSlotTicks)) & 1u;
 
-                        bool has2 = false, has4 = false;
-                        for (auto& n : out)
-                            if (n.row == row && (n.startTick == b2 || n.startTick == b4)) { if (n.startTick == b2) has2 = true; else has4 = true; }
+                        auto br = hitRng(bar, row, kStepsPerBar); // the step after the bar: backbeat fills
+                        if (!has2) place(bar, row, b2, spec.rows[row].lenTicks, randRange(br, spec.rows[row].velMin, spec.rows[row].velMax));
+                        if (!has4) place(bar, row, b4, spec.rows[row].lenTicks, randRange(br, spec.rows[row].velMin, spec.rows[row].velMax));
+                    }
+                }
+            }
+
+            // Emit in time order: walk each bar's occupied slots, rows inside a slot ordered by tick
+            int total = 0;
+            for (auto m : occ) total += juce::countNumberOfBits((juce::uint64)m);
+            out.ensureStorageAllocated(total);
+
+            for (int bar = 0; bar < bars; ++bar)
+            {
+                std::uint64_t any = 0;
+                for (int row = 0; row < NumRows; ++row) any |= occAt(bar, row);
+
+                for (int slot = 0; any != 0; ++slot, any >>= 1)
+                {
+                    if ((any & 1u) == 0) continue;
 
-                        if (!has2) out.add({ row, b2, spec.rows[row].lenTicks, randRange(rng, spec.rows[row].velMin, spec.rows[row].velMax) });
-                        if (!has4) out.add({ row, b4, spec.rows[row].lenTicks, randRange(rng, spec.rows[row].velMin, spec.rows[row].velMax) });
+                    const int first = out.size();
+                    for (int row = 0; row < NumRows; ++row)
+                    {
+                        if (((occAt(bar, row) >> slot) & 1u) == 0) continue;
+                        const Cell& c = cells[((size_t)bar * NumRows + (size_t)row) * kSlotsPerBar + (size_t)slot];
+                        DrumNote n { row, c.tick, c.len, c.vel };
+
+                        int i = out.size();
+                        out.add(n);
+                        for (; i > first && out.getReference(i - 1).startTick > n.startTick; --i)
+                            out.getReference(i) = out.getReference(i - 1);
+                        out.getReference(i) = n;
                     }
                 }
             }
         }
+
+        // === Phrasing ==============================================================
+
+        static constexpr int kBarTicks = 24 * kStepsPerBar;
+        static constexpr int kBeatTicks = 4 * 24;
+
+        // One bar's notes, bar-relative ticks, sorted by tick
+        using BarNotes = std::vector<DrumNote>;
+
+        static void splitBars(const DrumPattern& p, int bars, std::vector<BarNotes>& out)
+        {
+            out.assign((size_t)bars, {});
+            for (const auto& n : p)
+            {
+                const int bar = n.startTick / kBarTicks;
+                if (bar >= 0 && bar < bars)
+                    out[(size_t)bar].push_back({ n.row, n.startTick - bar * kBarTicks, n.lenTicks, n.vel });
+            }
+        }
+
+        static void insertSorted(BarNotes& b, const DrumNote& n)
+        {
+            auto it = b.end();
+            while (it != b.begin() && (it - 1)->startTick > n.startTick) --it;
+            b.insert(it, n);
+        }
+
+        static bool hasSlot(const BarNotes& b, int row, int tick)
+        {
+            for (const auto& n : b)
+                if (n.row == row && n.startTick / kSlotTicks == tick / kSlotTicks) return true;
+            return false;
+        }
+
+        // The downbeat kick and the 2/4 snare or clap stay put through every mutation
+        static bool isBackbone(const DrumNote& n)
+        {
+            if (n.row == Kick) return n.startTick == 0;
+            if (n.row == Snare || n.row == Clap) return n.startTick == kBeatTicks || n.startTick == 3 * kBeatTicks;
+            return false;
+        }
+
+        static bool isOrnamentRow(int row) { return row == Kick || row == ClosedHat || row == OpenHat || row == Perc; }
+
+        // Small: drop one ornament and borrow one from the alternate take
+        static void mutateSmall(BarNotes& b, const BarNotes& alt, boom::Rng& rng)
+        {
+            int pool[64]; int n = 0;
+            for (int i = 0; i < (int)b.size() && n < 64; ++i)
+                if (isOrnamentRow(b[(size_t)i].row) && !isBackbone(b[(size_t)i])) pool[n++] = i;
+            if (n > 0) b.erase(b.begin() + pool[rng.below(n)]);
+
+            n = 0;
+            for (int i = 0; i < (int)alt.size() && n < 64; ++i)
+                if (isOrnamentRow(alt[(size_t)i].row) && !hasSlot(b, alt[(size_t)i].row, alt[(size_t)i].startTick)) pool[n++] = i;
+            if (n > 0) insertSorted(b, alt[(size_t)pool[rng.below(n)]]);
+        }
+
+        // Big: kick and hat lanes come from the alternate take, snare/clap/perc stay
+        static void mutateBig(BarNotes& b, const BarNotes& alt)
+        {
+            auto swapped = [](const DrumNote& n) { return (n.row == Kick || n.row == ClosedHat || n.row == OpenHat) && !isBackbone(n); };
+            b.erase(std::remove_if(b.begin(), b.end(), swapped), b.end());
+            for (const auto& n : alt)
+                if (swapped(n) && !hasSlot(b, n.row, n.startTick)) insertSorted(b, n);
+        }
+
+        // Fill: the last beat turns into a snare run from the backbeat, 16ths then 32nds or 16ths
+        static void addFill(BarNotes& b, const DrumStyleSpec& spec, boom::Rng& rng)
+        {
+            const int from = 3 * kBeatTicks;
+            b.erase(std::remove_if(b.begin(), b.end(), [&](const DrumNote& n)
+                {
+                    return n.startTick >= from && (n.row == Snare || n.row == ClosedHat || n.row == OpenHat);
+                }), b.end());
+
+            const RowSpec& rs = spec.rows[Snare];
+            const int rate2 = rng.nextBool() ? 12 : 24;
+            int ticks[8]; int count = 0;
+            for (int t = from; t < from + kBeatTicks / 2; t += 24) ticks[count++] = t;
+            for (int t = from + kBeatTicks / 2; t < from + kBeatTicks; t += rate2) ticks[count++] = t;
+
+            const int v0 = juce::jlimit(1, 127, rs.velMin - 10), v1 = juce::jlimit(1, 127, rs.velMax);
+            for (int k = 0; k < count; ++k)
+                insertSorted(b, { Snare, ticks[k], juce::jmin(rs.lenTicks, rate2), v0 + (v1 - v0) * k / juce::jmax(1, count - 1) });
+        }
+
+        void generate(const DrumStyleSpec& spec, int bars,
+            int restPct, int dottedPct, int tripletPct, int swingPct,
+            int seed, DrumPattern& out, const boom::PatternLocks* locks)
+        {
+            bars = juce::jlimit(1, 128, bars);
+
+            std::uint32_t rowMask = (1u << NumRows) - 1u;
+            if (locks != nullptr) rowMask &= ~locks->rows;
+            auto barOpen = [locks](int bar) { return locks == nullptr || !locks->barLocked(bar); };
+
+            // Seeds come from boom::seed keys in the callers; same seed, same pattern
+            boom::Rng rng(static_cast<std::uint64_t>(static_cast<std::uint32_t>(seed)));
+
+            boom::phrase::Cadence cadence;
+            cadence.cellBars = 2;
+            cadence.smallMin = spec.varyEveryBarsMin;
+            cadence.smallMax = spec.varyEveryBarsMax;
+            cadence.bigEvery = 8;
+            cadence.phraseBars = 4;
+
+            const int cellBars = juce::jmin(bars, cadence.cellBars);
+            generateBars(spec, cellBars, restPct, dottedPct, tripletPct, swingPct, rng, out, rowMask);
+
+            // Locked cell bars still feed the later copies; they just aren't part of the output
+            auto dropLockedCellBars = [&]
+            {
+                int kept = 0;
+                for (int i = 0; i < out.size(); ++i)
+                    if (barOpen(out.getReference(i).startTick / kBarTicks))
+                        out.getReference(kept++) = out.getReference(i);
+                out.removeRange(kept, out.size() - kept);
+            };
+            if (bars == cellBars) { dropLockedCellBars(); return; }
+
+            // Everything past the cell: a copy of a cell bar plus the planned moves. The alternate
+            // take (same spec, next draws) is what small and big mutations borrow from.
+            DrumPattern altPattern;
+            generateBars(spec, cellBars, restPct, dottedPct, tripletPct, swingPct, rng, altPattern, rowMask);
+
+            std::vector<BarNotes> cell, alt;
+            splitBars(out, cellBars, cell);
+            splitBars(altPattern, cellBars, alt);
+            dropLockedCellBars();
+
+            std::vector<boom::phrase::Bar> plan;
+            boom::phrase::plan(cadence, bars, rng, plan);
+
+            // Each bar's moves draw from their own stream, so one bar's note count can't shift another's
+            const std::uint64_t moveSalt = rng.next();
+
+            out.ensureStorageAllocated(out.size() * ((bars + cellBars - 1) / cellBars) + bars * 8);
+            BarNotes b;
+            for (int bar = cellBars; bar < bars; ++bar)
+            {
+                if (!barOpen(bar)) continue; // locked bars are never built
+                const auto& p = plan[(size_t)bar];
+                boom::Rng mr(boom::splitmix64(moveSalt + (std::uint64_t)bar));
+                b = cell[(size_t)p.source];
+                if (p.moves & boom::phrase::Big)   mutateBig(b, alt[(size_t)p.source]);
+                if (p.moves & boom::phrase::Small) mutateSmall(b, alt[(size_t)p.source], mr);
+                if (p.moves & boom::phrase::Fill)  addFill(b, spec, mr);
+
+                for (const auto& n : b)
+                    if ((rowMask >> n.row) & 1u) // fill notes in a locked row (the snare run) are discarded
+                        out.add({ n.row, bar * kBarTicks + n.startTick, n.lenTicks, n.vel });
+            }
+        }
     }
 } // namespace
@@ -1,5 +1,7 @@
 #pragma once
 #include <JuceHeader.h>
+#include <cstdint>
+#include "PatternLocks.h"
 
 namespace boom {
     namespace drums
@@ -7,6 +9,10 @@ namespace boom {
         // We generate on a 16th-grid then convert to 96 PPQ (one 16th = 24 ticks).
         static constexpr int kStepsPerBar = 16;
 
+        // Occupancy resolution: one bit per 6 ticks, so a bar (384 ticks) is exactly one uint64
+        static constexpr int kSlotTicks = 6;
+        static constexpr int kSlotsPerBar = 64;
+
         // Logical drum rows in your grid. Keep these aligned to what DrumGridComponent expects.
         enum Row
         {
@@ -32,11 +38,31 @@ namespace boom {
             // Humanize windows (ticks @ 96 PPQ)
             int timingJitterTicks = 0;
             int lenTicks = 24;          // default 1x 16th
+            // Occupancy rules (checked against the per-bar bitsets while generating)
+            int maxHitsPerBar = 0;      // 0 = no cap
+            int avoidRow = -1;          // skip a hit when this row already sounds in the same slot
         };
 
+        // Every built-in style, in table / combobox order
+        enum class StyleId : std::uint8_t
+        {
+            Trap = 0,
+            Drill,
+            EDM,
+            Reggaeton,
+            RnB,
+            Pop,
+            Rock,
+            Wxstie,
+            HipHop,
+            NumStyles
+        };
+
+        static constexpr int kNumStyles = (int)StyleId::NumStyles;
+
         struct DrumStyleSpec
         {
-            juce::String name;
+            const char* name = "";
 
             // Global feel controls
             float swingPct = 0.0f;          // 0..100; applied to 8th offbeats
@@ -51,15 +77,44 @@ namespace boom {
 
             // Backbeat anchors (snare/clap typical hits in 4/4: steps 4,12 at 16ths)
             bool lockBackbeat = true;
+
+            // Phrasing: bars between small variations (from boom::StyleRules when the table is compiled)
+            int varyEveryBarsMin = 2;
+            int varyEveryBarsMax = 4;
         };
 
-        // All supported names (for comboboxes, etc.)
-        const juce::StringArray styleNames();
+        // All supported names (for comboboxes, etc.), index == (int)StyleId
+        const juce::StringArray& styleNames();
+        const char* styleName(StyleId id) noexcept;
+
+        // Name -> id, resolved once where a name comes in (UI, parameters); trimmed, case-insensitive.
+        bool findStyle(const juce::String& name, StyleId& out);
+        StyleId styleFromName(const juce::String& name, StyleId fallback = StyleId::HipHop);
+        StyleId styleFromIndex(int index) noexcept; // clamped
+
+        // The compiled, immutable spec for a style: an array index, built once at load time
+        const DrumStyleSpec& getSpec(StyleId id) noexcept;
+
+        // Convenience for name-based callers; unknown names fall back to "hip hop"
+        inline const DrumStyleSpec& getSpec(const juce::String& styleName) { return getSpec(styleFromName(styleName)); }
+
+        // Row-by-row interpolation of two specs (t = 0 -> a, 1 -> b): step probabilities, velocity
+        // ranges, roll probabilities, swing and feel biases; discrete rules come from the nearer style.
+        DrumStyleSpec blendSpecs(const DrumStyleSpec& a, const DrumStyleSpec& b, float t);
 
-        // Lookup by canonical style name; guaranteed to return a valid spec (falls back to "hiphop").
-        DrumStyleSpec getSpec(const juce::String& styleName);
+        // Blend of two built-in styles with weightB quantized to 1/kBlendSteps. Blends are cached by
+        // (pair, step), so sweeping the blend slider only builds each step once.
+        static constexpr int kBlendSteps = 32;
+        DrumStyleSpec blendedSpec(StyleId a, StyleId b, float weightB);
 
         // Core generator that fills a pattern (row,startTick,lenTicks,velocity) for 'bars' bars.
+        // A 2-bar cell is generated in full; later bars are copies of it with small variations every
+        // varyEveryBars, a bigger one every 8 bars and a fill closing each 4-bar phrase.
+        // Seed-stable: with the same seed, a feel slider only changes what it acts on (hits crossing
+        // their threshold, swung offbeats); other hits keep their place and velocity.
+        // Locks (optional): locked rows and bars are left out of 'out' and cost nothing to generate;
+        // each row draws its hits from its own stream, so an unlocked row comes out as it would
+        // with nothing locked (phrase mutations aside).
         struct DrumNote { int row; int startTick; int lenTicks; int vel; };
         using DrumPattern = juce::Array<DrumNote>;
 
@@ -69,8 +124,9 @@ namespace boom {
             int dottedPct,      // 0..100
             int tripletPct,     // 0..100
             int swingPct,       // 0..100 (applies to hats/openhat/perc mostly)
-            int seed,
-            DrumPattern& out);
+            int seed,           // derive from a boom::seed::Key; same seed => same pattern
+            DrumPattern& out,
+            const boom::PatternLocks* locks = nullptr);
     }
 } // namespace
 
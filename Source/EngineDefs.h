@@ -1,5 +1,6 @@
 ﻿#pragma once
 #include <JuceHeader.h>
+#include "ScaleEngine.h"
 
 namespace boom
 {
@@ -230,15 +231,13 @@ namespace boom
 
     inline const juce::StringArray& scaleChoices()
     {
-        // Full BANG list you provided
-        static const juce::StringArray c {
-            "Major", "Natural Minor", "Harmonic Minor", "Dorian", "Phrygian", "Lydian", "Mixolydian", "Aeolian", "Locrian",
-                "Locrian Nat6", "Ionian #5", "Dorian #4", "Phrygian Dom", "Lydian #2", "Super Locrian", "Dorian b2",
-                "Lydian Aug", "Lydian Dom", "Mixo b6", "Locrian #2", "8 Tone Spanish", "Phrygian Nat3",
-                "Blues", "Hungarian Min", "Harmonic Maj(Ethiopian)", "Dorian b5", "Phrygian b4", "Lydian b3", "Mixolydian b2",
-                "Lydian Aug2", "Locrian bb7", "Pentatonic Maj", "Pentatonic Min", "Neopolitan Maj",
-                "Neopolitan Min", "Spanish Gypsy", "Romanian Minor", "Chromatic", "Bebop Major", "Bebop Minor"
-        };
+        // Full BANG list, straight from the scale table (index = scale id, see ScaleEngine.h)
+        static const juce::StringArray c = []
+        {
+            juce::StringArray names;
+            for (const auto& s : scale::kScales) names.add(s.name);
+            return names;
+        }();
         return c;
     }
 
@@ -260,7 +259,7 @@ namespace boom
 
     inline const juce::StringArray& barsChoices()
     {
-        static const juce::StringArray c { "4", "8" };
+        static const juce::StringArray c { "4", "8", "16", "32", "64", "128" }; // appended only: saved indices keep their meaning
         return c;
     }
 
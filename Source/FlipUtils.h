@@ -1,5 +1,6 @@
 #pragma once
 #include <JuceHeader.h>
+#include "BoomRandom.h"
 
 namespace boom::flip
 {
@@ -11,15 +12,15 @@ namespace boom::flip
 
     inline void microFlipDrums(DrumPattern& pat, int seed, int density, int bars = 4)
     {
-        juce::Random rng(seed);
+        boom::Rng rng((std::uint64_t)(std::uint32_t)seed);
         const int ops = juce::jlimit(1, 16, density / 6);
         const int ticksPerStep = 24;
         const int cols = bars * 16;
 
         for (int i = 0; i < ops && !pat.isEmpty(); ++i)
         {
-            auto& e = pat.getReference(rng.nextInt(pat.size()));
-            const int kind = rng.nextInt({0,3}); // 0 shift step, 1 change len, 2 swap row
+            auto& e = pat.getReference(rng.below(pat.size()));
+            const int kind = rng.below(3); // 0 shift step, 1 change len, 2 swap row
             if (kind == 0)
             {
                 int col = (e.startTick / ticksPerStep);
@@ -40,15 +41,15 @@ namespace boom::flip
 
     inline void microFlipMelodic(MelodicPattern& pat, int seed, int density, int bars = 4)
     {
-        juce::Random rng(seed);
+        boom::Rng rng((std::uint64_t)(std::uint32_t)seed);
         const int ops = juce::jlimit(1, 20, juce::roundToInt(density / 5.0));
         const int ticksPerStep = 24;
         const int cols = bars * 16;
 
         for (int i = 0; i < ops && !pat.isEmpty(); ++i)
         {
-            auto& n = pat.getReference(rng.nextInt(pat.size()));
-            const int kind = rng.nextInt({0,3}); // 0 nudge start, 1 len, 2 gap
+            auto& n = pat.getReference(rng.below(pat.size()));
+            const int kind = rng.below(3); // 0 nudge start, 1 len, 2 gap
             if (kind == 0)
             {
                 int col = (n.startTick / ticksPerStep);
@@ -0,0 +1,136 @@
+#pragma once
+#include <JuceHeader.h>
+#include <atomic>
+#include <cstdint>
+#include <functional>
+
+namespace boom
+{
+    // One worker thread for generator jobs, so long forms and candidate searches never block the
+    // message thread. Requests coalesce: submit() replaces a job that hasn't started yet, and a job
+    // that is running sees its Cancel flip and stops at its next check. Only the newest request's
+    // result is delivered, on the message thread, through onResult.
+    template <typename Result>
+    class GenerationService : private juce::Thread, private juce::AsyncUpdater
+    {
+    public:
+        // Jobs poll this between stages; true once a newer request, cancel() or shutdown superseded them
+        class Cancel
+        {
+        public:
+            bool operator()() const noexcept
+            {
+                return owner.latest.load(std::memory_order_acquire) != ticket || owner.threadShouldExit();
+            }
+
+        private:
+            friend class GenerationService;
+            Cancel(const GenerationService& o, std::uint64_t t) noexcept : owner(o), ticket(t) {}
+            const GenerationService& owner;
+            const std::uint64_t ticket;
+        };
+
+        // Runs on the worker: fill 'out', return false when cancelled. Capture copies only; the job
+        // must not read processor or parameter state, which belongs to the message thread.
+        using Job = std::function<bool(const Cancel&, Result& out)>;
+
+        std::function<void(Result&&)> onResult; // message thread
+
+        GenerationService() : juce::Thread("BOOM generation") {}
+        ~GenerationService() override { shutdown(); }
+
+        // Message thread. Returns the request's ticket.
+        std::uint64_t submit(Job job)
+        {
+            std::uint64_t t = 0;
+            {
+                const juce::ScopedLock sl(lock);
+                pending = std::move(job);
+                t = latest.fetch_add(1, std::memory_order_acq_rel) + 1;
+            }
+            if (!isThreadRunning()) startThread();
+            notify();
+            return t;
+        }
+
+        // Drop the queued job and cancel the running one; nothing is delivered for either
+        void cancel()
+        {
+            {
+                const juce::ScopedLock sl(lock);
+                pending = nullptr;
+                latest.fetch_add(1, std::memory_order_acq_rel);
+            }
+            cancelPendingUpdate();
+        }
+
+        bool isBusy() const noexcept
+        {
+            if (busy.load(std::memory_order_acquire)) return true;
+            const juce::ScopedLock sl(lock);
+            return pending != nullptr;
+        }
+
+        void shutdown()
+        {
+            cancel();
+            signalThreadShouldExit();
+            notify();
+            stopThread(4000);
+        }
+
+    private:
+        void run() override
+        {
+            while (!threadShouldExit())
+            {
+                Job job;
+                std::uint64_t t = 0;
+                {
+                    const juce::ScopedLock sl(lock);
+                    job = std::move(pending);
+                    pending = nullptr;
+                    t = latest.load(std::memory_order_acquire);
+                    busy.store(job != nullptr, std::memory_order_release); // under the lock: isBusy never sees a gap
+                }
+                if (!job) { wait(-1); continue; }
+
+                Result r {};
+                const Cancel cancelled(*this, t);
+                const bool ok = job(cancelled, r) && !cancelled();
+                busy.store(false, std::memory_order_release);
+                if (!ok) continue;
+
+                {
+                    const juce::ScopedLock sl(lock);
+                    ready = std::move(r);
+                    readyTicket = t;
+                    hasReady = true;
+                }
+                triggerAsyncUpdate();
+            }
+        }
+
+        void handleAsyncUpdate() override
+        {
+            Result r {};
+            {
+                const juce::ScopedLock sl(lock);
+                if (!hasReady) return;
+                hasReady = false;
+                if (readyTicket != latest.load(std::memory_order_acquire)) return; // superseded meanwhile
+                r = std::move(ready);
+            }
+            if (onResult) onResult(std::move(r));
+        }
+
+        juce::CriticalSection lock;
+        Job pending;                          // at most one queued job: newer requests replace it
+        std::atomic<std::uint64_t> latest { 0 };
+        std::atomic<bool> busy { false };
+
+        Result ready {};
+        std::uint64_t readyTicket = 0;
+        bool hasReady = false;
+    };
+}
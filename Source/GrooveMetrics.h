@@ -0,0 +1,326 @@
+#pragma once
+#include <JuceHeader.h>
+#include <cmath>
+#include <cstdint>
+#include <type_traits>
+#include <vector>
+
+// Objective descriptors of a pattern for ranking, search and UI badges. A pattern is viewed as one
+// bitset per row on the 16th grid (4 bars per 64-bit word) plus structure-of-arrays copies of the note
+// ticks and velocities, so the grid measures are popcounts of masked words and the timing/velocity
+// measures are straight loops over contiguous arrays. Build into a reused Grid inside batch loops.
+namespace boom::groove
+{
+    static constexpr int kRows = 6;   // drum rows (boom::drums::Row); melodic lines go on row 0
+    enum { Kick = 0, Snare = 1, ClosedHat = 2, OpenHat = 3, Clap = 4, Perc = 5 };
+
+    // 16-step masks repeated over the four bars of a word
+    static constexpr std::uint64_t kRepeat4 = 0x0001000100010001ull;
+    static constexpr std::uint64_t kOffbeat16 = 0xAAAAull * kRepeat4;   // e / a positions
+    static constexpr std::uint64_t kQuarters = 0x1111ull * kRepeat4;
+    // Metric levels (4 = downbeat, 3 = half bar, 2 = beats, 1 = 8ths, 0 = 16ths), as in LHL-style measures
+    static constexpr std::uint64_t kLevel[5] = { 0xAAAAull * kRepeat4, 0x4444ull * kRepeat4, 0x1010ull * kRepeat4,
+                                                 0x0100ull * kRepeat4, 0x0001ull * kRepeat4 };
+
+    inline int popcount(std::uint64_t v) noexcept { return juce::countNumberOfBits((juce::uint64)v); }
+
+    struct Grid
+    {
+        int bars = 0, words = 0;
+        std::vector<std::uint64_t> bits;     // [row * words + word]
+        std::vector<int>   tick;             // SoA note data, in input order
+        std::vector<int>   row;
+        std::vector<float> vel;              // 0..1
+
+        const std::uint64_t* rowBits(int r) const noexcept { return bits.data() + (size_t)r * (size_t)words; }
+
+        std::uint16_t barMask(int bar, int r) const noexcept
+        {
+            return (std::uint16_t)(rowBits(r)[bar / 4] >> ((bar % 4) * 16));
+        }
+
+        // Bits of bars >= 'bars' in the last word (always zero, but masks built from constants need it)
+        std::uint64_t validMask(int word) const noexcept
+        {
+            const int left = bars - word * 4;
+            return left >= 4 ? ~0ull : ((1ull << (left * 16)) - 1ull);
+        }
+    };
+
+    namespace detail
+    {
+        template <typename N, typename = void> struct HasVelocity : std::false_type {};
+        template <typename N> struct HasVelocity<N, std::void_t<decltype(std::declval<N>().velocity)>> : std::true_type {};
+
+        // Processor notes carry 'velocity', drum-generator notes 'vel'
+        template <typename N> inline int velocityOf(const N& n)
+        {
+            if constexpr (HasVelocity<N>::value) return (int)n.velocity;
+            else                                 return (int)n.vel;
+        }
+    }
+
+    // Any note container with .row, .startTick (96 PPQ) and .velocity or .vel. allOnRow >= 0 puts every
+    // note on that row (melodic lines, whose row field isn't a lane). Reuses g's storage.
+    template <typename Notes>
+    inline void build(Grid& g, const Notes& notes, int bars, int allOnRow = -1)
+    {
+        g.bars = juce::jmax(1, bars);
+        g.words = (g.bars + 3) / 4;
+        g.bits.assign((size_t)g.words * kRows, 0ull);
+        g.tick.clear(); g.row.clear(); g.vel.clear();
+
+        for (const auto& n : notes)
+        {
+            const int r = allOnRow >= 0 ? allOnRow : n.row;
+            const int s16 = (n.startTick + 12) / 24;   // nearest 16th
+            if (r < 0 || r >= kRows || s16 < 0 || s16 >= g.bars * 16) continue;
+
+            g.bits[(size_t)r * (size_t)g.words + (size_t)(s16 / 64)] |= 1ull << (s16 % 64);
+            g.tick.push_back(n.startTick);
+            g.row.push_back(r);
+            g.vel.push_back((float)juce::jlimit(0, 127, detail::velocityOf(n)) * (1.0f / 127.0f));
+        }
+    }
+
+    template <typename Notes>
+    inline Grid makeGrid(const Notes& notes, int bars, int allOnRow = -1)
+    {
+        Grid g;
+        build(g, notes, bars, allOnRow);
+        return g;
+    }
+
+    // ---- Kernels ----
+
+    // Four independent accumulators so the loop vectorizes (and doesn't serialize on one add)
+    inline float dot(const float* a, const float* b, int n) noexcept
+    {
+        float s0 = 0.0f, s1 = 0.0f, s2 = 0.0f, s3 = 0.0f;
+        int i = 0;
+        for (; i + 4 <= n; i += 4)
+        {
+            s0 += a[i] * b[i];
+            s1 += a[i + 1] * b[i + 1];
+            s2 += a[i + 2] * b[i + 2];
+            s3 += a[i + 3] * b[i + 3];
+        }
+        for (; i < n; ++i) s0 += a[i] * b[i];
+        return (s0 + s1) + (s2 + s3);
+    }
+
+    inline float sum(const float* a, int n) noexcept
+    {
+        float s0 = 0.0f, s1 = 0.0f, s2 = 0.0f, s3 = 0.0f;
+        int i = 0;
+        for (; i + 4 <= n; i += 4) { s0 += a[i]; s1 += a[i + 1]; s2 += a[i + 2]; s3 += a[i + 3]; }
+        for (; i < n; ++i) s0 += a[i];
+        return (s0 + s1) + (s2 + s3);
+    }
+
+    // popcount(a[i] & m) summed over n words
+    inline int countMasked(const std::uint64_t* a, int n, std::uint64_t m) noexcept
+    {
+        int c = 0;
+        for (int i = 0; i < n; ++i) c += popcount(a[i] & m);
+        return c;
+    }
+
+    // ---- Measures (all 0..1 unless noted) ----
+
+    inline float rowDensity(const Grid& g, int r) noexcept
+    {
+        return (float)countMasked(g.rowBits(r), g.words, ~0ull) / (float)(g.bars * 16);
+    }
+
+    inline float totalDensity(const Grid& g) noexcept
+    {
+        return (float)countMasked(g.bits.data(), (int)g.bits.size(), ~0ull) / (float)(g.bars * 16 * kRows);
+    }
+
+    // Rows to combine, as a bit per row
+    static constexpr int kBackboneRows = (1 << Kick) | (1 << Snare) | (1 << Clap);
+    static constexpr int kAllRows = (1 << kRows) - 1;
+
+    inline std::uint64_t unionWord(const Grid& g, int word, int rows) noexcept
+    {
+        std::uint64_t u = 0;
+        for (int r = 0; r < kRows; ++r)
+            if (rows & (1 << r)) u |= g.rowBits(r)[word];
+        return u;
+    }
+
+    // Share of hit weight away from strong positions: sum(4 - level) / (4 * hits) over the chosen rows
+    inline float syncopation(const Grid& g, int rows = kBackboneRows) noexcept
+    {
+        int weighted = 0, hits = 0;
+        for (int w = 0; w < g.words; ++w)
+        {
+            const std::uint64_t u = unionWord(g, w, rows);
+            hits += popcount(u);
+            for (int level = 0; level < 5; ++level)
+                weighted += (4 - level) * popcount(u & kLevel[level]);
+        }
+        return hits > 0 ? (float)weighted / (float)(4 * hits) : 0.0f;
+    }
+
+    // Hits on the e / a 16ths
+    inline float offbeatRatio(const Grid& g, int rows = kAllRows) noexcept
+    {
+        int off = 0, hits = 0;
+        for (int w = 0; w < g.words; ++w)
+        {
+            const std::uint64_t u = unionWord(g, w, rows);
+            hits += popcount(u);
+            off += popcount(u & kOffbeat16);
+        }
+        return hits > 0 ? (float)off / (float)hits : 0.0f;
+    }
+
+    // Bars with snare or clap on both 2 and 4
+    inline float backbeat(const Grid& g) noexcept
+    {
+        int ok = 0;
+        for (int bar = 0; bar < g.bars; ++bar)
+        {
+            const int m = g.barMask(bar, Snare) | g.barMask(bar, Clap);
+            if ((m & (1 << 4)) && (m & (1 << 12))) ++ok;
+        }
+        return (float)ok / (float)g.bars;
+    }
+
+    // Jaccard similarity of every bar to the bar before it (1 = the bar loops exactly)
+    inline float repetition(const Grid& g, int rows = kAllRows) noexcept
+    {
+        if (g.bars < 2) return 1.0f;
+        int inter = 0, uni = 0;
+        std::uint64_t carry = 0;
+        for (int w = 0; w < g.words; ++w)
+        {
+            const std::uint64_t cur = unionWord(g, w, rows) & g.validMask(w);
+            std::uint64_t prev = ((cur << 16) | carry) & g.validMask(w);   // bar b lined up with bar b - 1
+            std::uint64_t self = cur;
+            if (w == 0) { prev &= ~0xFFFFull; self &= ~0xFFFFull; } // bar 0 has no predecessor
+            inter += popcount(self & prev);
+            uni += popcount(self | prev);
+            carry = cur >> 48;
+        }
+        return uni > 0 ? (float)inter / (float)uni : 1.0f;
+    }
+
+    // Kicks that land on 'anchor' onsets (row 0 of another grid, e.g. the bass), or on the beat without one
+    inline float kickAlignment(const Grid& g, const Grid* anchor = nullptr) noexcept
+    {
+        int kicks = 0, aligned = 0;
+        for (int w = 0; w < g.words; ++w)
+        {
+            const std::uint64_t k = g.rowBits(Kick)[w];
+            const std::uint64_t a = (anchor != nullptr && w < anchor->words) ? anchor->rowBits(0)[w] : kQuarters;
+            kicks += popcount(k);
+            aligned += popcount(k & a);
+        }
+        return kicks > 0 ? (float)aligned / (float)kicks : 0.0f;
+    }
+
+    // Long/short ratio of swung 16th pairs from the delay of the off-16ths (1 = straight, 2 = triplet feel).
+    // Only delays up to half a 16th count, so 32nd rolls don't read as swing.
+    inline float swingRatio(const Grid& g) noexcept
+    {
+        int n = 0, delay = 0;
+        for (size_t i = 0; i < g.tick.size(); ++i)
+        {
+            const int s16 = g.tick[i] / 24;
+            const int d = g.tick[i] - s16 * 24;
+            if ((s16 & 1) == 0 || d > 12) continue;      // off-16ths only
+            delay += d;
+            ++n;
+        }
+        if (n == 0) return 1.0f;
+        const float d = (float)delay / (float)n;
+        return (24.0f + d) / (24.0f - d);
+    }
+
+    inline float velocityVariance(const Grid& g) noexcept
+    {
+        const int n = (int)g.vel.size();
+        if (n == 0) return 0.0f;
+        const float mean = sum(g.vel.data(), n) / (float)n;
+        return juce::jmax(0.0f, dot(g.vel.data(), g.vel.data(), n) / (float)n - mean * mean);
+    }
+
+    // Shannon entropy of the inter-onset intervals (in 16ths, capped at a bar) of the combined rows,
+    // normalized to 0..1 by log2(16)
+    inline float ioiEntropy(const Grid& g, int rows = kAllRows) noexcept
+    {
+        int hist[17] = {};
+        int total = 0, last = -1;
+        for (int w = 0; w < g.words; ++w)
+        {
+            for (std::uint64_t u = unionWord(g, w, rows); u != 0; u &= u - 1)
+            {
+                const int pos = w * 64 + popcount((u & (~u + 1)) - 1); // index of the lowest set bit
+                if (last >= 0) { ++hist[juce::jmin(16, pos - last)]; ++total; }
+                last = pos;
+            }
+        }
+        if (total == 0) return 0.0f;
+        float h = 0.0f;
+        for (int c : hist)
+            if (c > 0)
+            {
+                const float p = (float)c / (float)total;
+                h -= p * std::log2(p);
+            }
+        return h / 4.0f;
+    }
+
+    // Jaccard similarity to a reference pattern over the chosen rows (compares the shorter length)
+    inline float similarity(const Grid& a, const Grid& b, int rows = kAllRows) noexcept
+    {
+        const int words = juce::jmin(a.words, b.words);
+        int inter = 0, uni = 0;
+        for (int r = 0; r < kRows; ++r)
+        {
+            if (!(rows & (1 << r))) continue;
+            const std::uint64_t* x = a.rowBits(r);
+            const std::uint64_t* y = b.rowBits(r);
+            for (int w = 0; w < words; ++w)
+            {
+                inter += popcount(x[w] & y[w]);
+                uni += popcount(x[w] | y[w]);
+            }
+        }
+        return uni > 0 ? (float)inter / (float)uni : 1.0f;
+    }
+
+    // Everything at once, for badges and logging
+    struct Metrics
+    {
+        float rowDensity[kRows] {};
+        float density = 0.0f;
+        float syncopation = 0.0f;
+        float offbeatRatio = 0.0f;
+        float backbeat = 0.0f;
+        float repetition = 0.0f;
+        float kickAlignment = 0.0f;
+        float swingRatio = 1.0f;
+        float velocityVariance = 0.0f;
+        float ioiEntropy = 0.0f;
+    };
+
+    inline Metrics analyse(const Grid& g, const Grid* kickAnchor = nullptr) noexcept
+    {
+        Metrics m;
+        for (int r = 0; r < kRows; ++r) m.rowDensity[r] = rowDensity(g, r);
+        m.density = totalDensity(g);
+        m.syncopation = syncopation(g);
+        m.offbeatRatio = offbeatRatio(g);
+        m.backbeat = backbeat(g);
+        m.repetition = repetition(g);
+        m.kickAlignment = kickAlignment(g, kickAnchor);
+        m.swingRatio = swingRatio(g);
+        m.velocityVariance = velocityVariance(g);
+        m.ioiEntropy = ioiEntropy(g);
+        return m;
+    }
+}
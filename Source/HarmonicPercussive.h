@@ -0,0 +1,175 @@
+#pragma once
+#include <JuceHeader.h>
+#include <complex>
+#include <vector>
+#include "OnsetDetection.h"
+#include "Parallel.h"
+
+// Median-filter harmonic/percussive separation (Fitzgerald style) over the STFT magnitude.
+// Sustained energy (bass notes, vocals, pads) is smooth along time; drum hits are smooth along
+// frequency. A running median in each direction estimates both, and a soft mask keeps the
+// percussive share before onset detection.
+namespace boom::hpss
+{
+    // Small iterative radix-2 FFT, enough for analysis frames (size must be a power of two)
+    class FFT
+    {
+    public:
+        explicit FFT(int order) : size(1 << order), rev((size_t)size), twiddle((size_t)size / 2)
+        {
+            for (int i = 0; i < size; ++i)
+            {
+                int r = 0;
+                for (int b = 0; b < order; ++b)
+                    if (i & (1 << b)) r |= 1 << (order - 1 - b);
+                rev[(size_t)i] = r;
+            }
+            for (int k = 0; k < size / 2; ++k)
+                twiddle[(size_t)k] = std::polar(1.0f, -juce::MathConstants<float>::twoPi * (float)k / (float)size);
+        }
+
+        int getSize() const noexcept { return size; }
+
+        void perform(std::vector<std::complex<float>>& x) const
+        {
+            for (int i = 0; i < size; ++i)
+                if (i < rev[(size_t)i]) std::swap(x[(size_t)i], x[(size_t)rev[(size_t)i]]);
+
+            for (int len = 2; len <= size; len <<= 1)
+            {
+                const int half = len / 2, step = size / len;
+                for (int s = 0; s < size; s += len)
+                    for (int k = 0; k < half; ++k)
+                    {
+                        const auto t = twiddle[(size_t)(k * step)] * x[(size_t)(s + k + half)];
+                        x[(size_t)(s + k + half)] = x[(size_t)(s + k)] - t;
+                        x[(size_t)(s + k)] += t;
+                    }
+            }
+        }
+
+    private:
+        int size;
+        std::vector<int> rev;
+        std::vector<std::complex<float>> twiddle;
+    };
+
+    // Magnitude spectrogram, frame-major: mag[frame * bins + bin]
+    struct Spectrogram
+    {
+        int frames = 0, bins = 0, hop = 0, win = 0;
+        std::vector<float> mag;
+
+        float at(int frame, int bin) const noexcept { return mag[(size_t)frame * (size_t)bins + (size_t)bin]; }
+    };
+
+    // Frames start every 'hop' samples while a full window fits (same framing as the time-domain envelopes)
+    inline Spectrogram stftMagnitude(const float* x, int N, int winOrder, int hop)
+    {
+        Spectrogram s;
+        s.win = 1 << winOrder;
+        s.hop = juce::jmax(1, hop);
+        s.bins = s.win / 2 + 1;
+        s.frames = (x != nullptr && N >= s.win) ? (N - s.win) / s.hop + 1 : 0;
+        s.mag.assign((size_t)s.frames * (size_t)s.bins, 0.0f);
+        if (s.frames == 0) return s;
+
+        const FFT fft(winOrder);
+        std::vector<float> window((size_t)s.win);
+        for (int n = 0; n < s.win; ++n)
+            window[(size_t)n] = 0.5f - 0.5f * std::cos(juce::MathConstants<float>::twoPi * (float)n / (float)s.win);
+
+        parallelFor(s.frames, 64, [&](int begin, int end)
+        {
+            std::vector<std::complex<float>> buf((size_t)s.win);
+            for (int f = begin; f < end; ++f)
+            {
+                const float* src = x + (size_t)f * (size_t)s.hop;
+                for (int n = 0; n < s.win; ++n)
+                    buf[(size_t)n] = { src[n] * window[(size_t)n], 0.0f };
+                fft.perform(buf);
+
+                float* dst = s.mag.data() + (size_t)f * (size_t)s.bins;
+                for (int b = 0; b < s.bins; ++b)
+                    dst[b] = std::abs(buf[(size_t)b]);
+            }
+        });
+        return s;
+    }
+
+    // Centred running median of 'count' values read through get(i), edges clamped.
+    // One SlidingQuantile per call, so each output costs O(log kernel).
+    template <typename Get, typename Put>
+    inline void runningMedian(int count, int kernel, onset::SlidingQuantile& med, Get&& get, Put&& put)
+    {
+        const int half = juce::jmax(0, kernel / 2);
+        med.reset();
+        for (int m = 0; m < count + 2 * half; ++m)
+        {
+            med.push(get(juce::jlimit(0, count - 1, m - half)));
+            if (m >= 2 * half)
+                put(m - 2 * half, med.value());
+        }
+    }
+
+    // Percussive part of the spectrogram: M * P^2 / (H^2 + P^2), with H = median along time
+    // (per bin) and P = median along frequency (per frame). Bins / frames run in parallel.
+    inline Spectrogram percussive(const Spectrogram& s, int timeKernel = 17, int freqKernel = 17)
+    {
+        Spectrogram out = s;
+        if (s.frames == 0) return out;
+
+        const size_t cells = (size_t)s.frames * (size_t)s.bins;
+        std::vector<float> harm(cells), perc(cells);
+        const size_t B = (size_t)s.bins;
+
+        parallelFor(s.bins, 16, [&](int begin, int end)
+        {
+            onset::SlidingQuantile med(0.5f, timeKernel | 1);
+            for (int b = begin; b < end; ++b)
+                runningMedian(s.frames, timeKernel | 1, med,
+                    [&](int f) { return s.mag[(size_t)f * B + (size_t)b]; },
+                    [&](int f, float v) { harm[(size_t)f * B + (size_t)b] = v; });
+        });
+
+        parallelFor(s.frames, 64, [&](int begin, int end)
+        {
+            onset::SlidingQuantile med(0.5f, freqKernel | 1);
+            for (int f = begin; f < end; ++f)
+            {
+                const size_t row = (size_t)f * B;
+                runningMedian(s.bins, freqKernel | 1, med,
+                    [&](int b) { return s.mag[row + (size_t)b]; },
+                    [&](int b, float v) { perc[row + (size_t)b] = v; });
+            }
+        });
+
+        for (size_t i = 0; i < cells; ++i)
+        {
+            const float h2 = harm[i] * harm[i], p2 = perc[i] * perc[i];
+            out.mag[i] = s.mag[i] * (p2 / (h2 + p2 + 1.0e-12f));
+        }
+        return out;
+    }
+
+    // Mean magnitude per frame inside [loHz, hiHz)
+    inline std::vector<float> bandEnvelope(const Spectrogram& s, double sampleRate, float loHz, float hiHz)
+    {
+        std::vector<float> env((size_t)s.frames, 0.0f);
+        if (s.frames == 0 || sampleRate <= 0.0) return env;
+
+        const double binHz = sampleRate / s.win;
+        const int b0 = juce::jlimit(0, s.bins - 1, (int)std::ceil(loHz / binHz));
+        const int b1 = juce::jlimit(b0 + 1, s.bins, (int)std::ceil(hiHz / binHz));
+        const float norm = 1.0f / (float)(b1 - b0);
+
+        for (int f = 0; f < s.frames; ++f)
+        {
+            const float* row = s.mag.data() + (size_t)f * (size_t)s.bins;
+            float e = 0.0f;
+            for (int b = b0; b < b1; ++b) e += row[b];
+            env[(size_t)f] = e * norm;
+        }
+        return env;
+    }
+}
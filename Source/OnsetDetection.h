@@ -0,0 +1,198 @@
+#pragma once
+#include <JuceHeader.h>
+#include <vector>
+
+namespace boom::onset
+{
+    // Running q-quantile of the last 'window' values, kept as two indexed heaps over a circular slot
+    // buffer: a max-heap 'lo' with the smallest rank(q) + 1 values and a min-heap 'hi' with the rest.
+    // Replacing the oldest value is a sift in one heap plus at most one root swap, so push is O(log w)
+    // with no allocation once constructed (HPSS runs millions of these).
+    class SlidingQuantile
+    {
+    public:
+        SlidingQuantile(float quantile = 0.5f, int windowSize = 64)
+            : q(juce::jlimit(0.0f, 1.0f, quantile)), window(juce::jmax(1, windowSize)),
+              vals((size_t)window), inLo((size_t)window), pos((size_t)window)
+        {
+            lo.reserve((size_t)window);
+            hi.reserve((size_t)window);
+        }
+
+        void reset() { lo.clear(); hi.clear(); head = count = 0; }
+
+        void push(float v)
+        {
+            if (count < window)
+            {
+                const int slot = (head + count) % window;
+                ++count;
+                vals[(size_t)slot] = v;
+                if (!lo.empty() && v <= vals[(size_t)lo[0]]) heapInsert(true, slot);
+                else                                         heapInsert(false, slot);
+                rebalance();
+                return;
+            }
+
+            // Full: overwrite the oldest slot in place and restore both heap orders
+            const int slot = head;
+            head = (head + 1) % window;
+            vals[(size_t)slot] = v;
+            const bool isLo = inLo[(size_t)slot] != 0;
+            siftUp(isLo, pos[(size_t)slot]);
+            siftDown(isLo, pos[(size_t)slot]);
+
+            if (!lo.empty() && !hi.empty() && vals[(size_t)lo[0]] > vals[(size_t)hi[0]])
+            {
+                std::swap(lo[0], hi[0]);
+                place(true, 0);
+                place(false, 0);
+                siftDown(true, 0);
+                siftDown(false, 0);
+            }
+        }
+
+        float value() const noexcept { return lo.empty() ? 0.0f : vals[(size_t)lo[0]]; }
+        int   size() const noexcept { return count; }
+
+    private:
+        // lo orders largest-first, hi smallest-first
+        bool before(bool isLo, int a, int b) const noexcept
+        {
+            return isLo ? vals[(size_t)a] > vals[(size_t)b] : vals[(size_t)a] < vals[(size_t)b];
+        }
+
+        std::vector<int>& heap(bool isLo) noexcept { return isLo ? lo : hi; }
+
+        void place(bool isLo, int i)
+        {
+            const int slot = heap(isLo)[(size_t)i];
+            inLo[(size_t)slot] = isLo ? 1 : 0;
+            pos[(size_t)slot] = i;
+        }
+
+        // Both sifts move a hole instead of swapping, so each level costs one write + one index update
+        void siftUp(bool isLo, int i)
+        {
+            auto& h = heap(isLo);
+            const int moving = h[(size_t)i];
+            while (i > 0)
+            {
+                const int parent = (i - 1) / 2;
+                if (!before(isLo, moving, h[(size_t)parent])) break;
+                h[(size_t)i] = h[(size_t)parent];
+                place(isLo, i);
+                i = parent;
+            }
+            h[(size_t)i] = moving;
+            place(isLo, i);
+        }
+
+        void siftDown(bool isLo, int i)
+        {
+            auto& h = heap(isLo);
+            const int n = (int)h.size();
+            const int moving = h[(size_t)i];
+            for (;;)
+            {
+                int child = 2 * i + 1;
+                if (child >= n) break;
+                if (child + 1 < n && before(isLo, h[(size_t)child + 1], h[(size_t)child])) ++child;
+                if (!before(isLo, h[(size_t)child], moving)) break;
+                h[(size_t)i] = h[(size_t)child];
+                place(isLo, i);
+                i = child;
+            }
+            h[(size_t)i] = moving;
+            place(isLo, i);
+        }
+
+        void heapInsert(bool isLo, int slot)
+        {
+            auto& h = heap(isLo);
+            h.push_back(slot);
+            place(isLo, (int)h.size() - 1);
+            siftUp(isLo, (int)h.size() - 1);
+        }
+
+        int heapPopRoot(bool isLo)
+        {
+            auto& h = heap(isLo);
+            const int root = h[0];
+            h[0] = h.back();
+            h.pop_back();
+            if (!h.empty())
+            {
+                place(isLo, 0);
+                siftDown(isLo, 0);
+            }
+            return root;
+        }
+
+        // While the window fills, lo must hold exactly rank(q) + 1 values
+        void rebalance()
+        {
+            const int want = count > 0 ? (int)std::floor(q * (float)(count - 1)) + 1 : 0;
+            while ((int)lo.size() > want)                 heapInsert(false, heapPopRoot(true));
+            while ((int)lo.size() < want && !hi.empty())  heapInsert(true, heapPopRoot(false));
+        }
+
+        float q;
+        int window;
+        std::vector<float> vals;          // circular slots, oldest at 'head'
+        std::vector<std::uint8_t> inLo;   // which heap a slot lives in
+        std::vector<int>   pos;           // index of a slot inside its heap
+        std::vector<int>   lo, hi;        // heaps of slot indices
+        int head = 0, count = 0;
+    };
+
+    // Streaming peak picker for an onset envelope. The threshold follows the local level instead of the
+    // take's global maximum: median + k * (p90 - median) over the last 'windowFrames', where k shrinks as
+    // sensitivity grows. A frame is confirmed one frame later (it must be a local maximum), so frames can be
+    // pushed as they arrive.
+    class AdaptivePeakPicker
+    {
+    public:
+        AdaptivePeakPicker(int windowFrames, int minGapFrames, float sensitivity01)
+            : median(0.5f, windowFrames), upper(0.9f, windowFrames),
+              minGap(juce::jmax(1, minGapFrames)),
+              k(juce::jmap(juce::jlimit(0.0f, 1.0f, sensitivity01), 3.0f, 0.5f)) {}
+
+        // Feed the next envelope value; returns the index of a frame confirmed as a peak, or -1
+        int push(float v)
+        {
+            median.push(v);
+            upper.push(v);
+
+            int found = -1;
+            if (frame >= 2)
+            {
+                const int cand = frame - 1;
+                if (prev > prevThreshold && prev > prev2 && prev >= v && (cand - lastPeak) >= minGap)
+                {
+                    found = cand;
+                    lastPeak = cand;
+                }
+            }
+
+            const float med = median.value();
+            const float spread = juce::jmax(upper.value() - med, 0.1f * med);
+            prevThreshold = med + k * spread + kFloor;
+
+            prev2 = prev;
+            prev = v;
+            ++frame;
+            return found;
+        }
+
+    private:
+        static constexpr float kFloor = 1.0e-4f; // keeps room noise / silence from triggering
+
+        SlidingQuantile median, upper;
+        int   minGap;
+        float k;
+        float prev = 0.0f, prev2 = 0.0f, prevThreshold = 0.0f;
+        int   frame = 0;
+        int   lastPeak = -1000000;
+    };
+}
@@ -0,0 +1,36 @@
+#pragma once
+#include <JuceHeader.h>
+#include <thread>
+#include <vector>
+
+namespace boom
+{
+    // Split [0, n) into contiguous chunks, one per available core, and run fn(begin, end) on each.
+    // The calling thread takes the first chunk; with one core (or less than minChunk items per core)
+    // it's just a plain call, so small jobs never pay for thread start-up.
+    template <typename Fn>
+    inline void parallelFor(int n, int minChunk, Fn&& fn)
+    {
+        if (n <= 0) return;
+
+        const int cores = juce::jmax(1, (int)std::thread::hardware_concurrency());
+        const int chunks = juce::jlimit(1, cores, n / juce::jmax(1, minChunk));
+        if (chunks <= 1)
+        {
+            fn(0, n);
+            return;
+        }
+
+        std::vector<std::thread> workers;
+        workers.reserve((size_t)chunks - 1);
+        for (int c = 1; c < chunks; ++c)
+        {
+            const int b = (int)((juce::int64)n * c / chunks);
+            const int e = (int)((juce::int64)n * (c + 1) / chunks);
+            workers.emplace_back([&fn, b, e] { fn(b, e); });
+        }
+
+        fn(0, (int)((juce::int64)n / chunks));
+        for (auto& w : workers) w.join();
+    }
+}
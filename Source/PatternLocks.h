@@ -0,0 +1,99 @@
+#pragma once
+#include <JuceHeader.h>
+#include <algorithm>
+#include <cstdint>
+
+// Which parts of a pattern a Generate must leave alone: whole rows (drum lanes) and whole bars
+// (every lane). Generators skip locked regions, so a re-roll costs only the unlocked area, and the
+// processor splices the fresh notes into the current pattern around what is locked.
+namespace boom
+{
+    struct PatternLocks
+    {
+        static constexpr int kMaxRows = 32;
+        static constexpr int kMaxBars = 128;
+
+        std::uint32_t rows = 0;                     // bit r: row r locked
+        std::uint64_t bars[kMaxBars / 64] {};       // bit b: bar b locked
+
+        bool any() const noexcept { return rows != 0 || (bars[0] | bars[1]) != 0; }
+        void clear() noexcept { rows = 0; bars[0] = bars[1] = 0; }
+
+        bool rowLocked(int row) const noexcept
+        {
+            return juce::isPositiveAndBelow(row, kMaxRows) && ((rows >> row) & 1u) != 0;
+        }
+
+        bool barLocked(int bar) const noexcept
+        {
+            return juce::isPositiveAndBelow(bar, kMaxBars) && ((bars[bar >> 6] >> (bar & 63)) & 1u) != 0;
+        }
+
+        bool locked(int row, int bar) const noexcept { return rowLocked(row) || barLocked(bar); }
+
+        void setRow(int row, bool on) noexcept
+        {
+            if (!juce::isPositiveAndBelow(row, kMaxRows)) return;
+            const std::uint32_t bit = 1u << row;
+            rows = on ? (rows | bit) : (rows & ~bit);
+        }
+
+        void setBar(int bar, bool on) noexcept
+        {
+            if (!juce::isPositiveAndBelow(bar, kMaxBars)) return;
+            const std::uint64_t bit = 1ull << (bar & 63);
+            auto& w = bars[bar >> 6];
+            w = on ? (w | bit) : (w & ~bit);
+        }
+
+        // True when nothing in 'numRows' x 'numBars' is left to generate (numRows = 0: bars only)
+        bool allLocked(int numRows, int numBars) const noexcept
+        {
+            const std::uint32_t all = numRows >= kMaxRows ? ~0u : ((1u << numRows) - 1u);
+            if (numRows > 0 && (rows & all) == all) return true;
+            for (int b = 0; b < numBars; ++b)
+                if (!barLocked(b)) return false;
+            return true;
+        }
+
+        std::uint64_t hash() const noexcept
+        {
+            return (std::uint64_t)rows * 0x9E3779B97F4A7C15ull ^ bars[0] ^ (bars[1] * 0xBF58476D1CE4E5B9ull);
+        }
+
+        // 'generated' becomes the notes of 'current' in locked regions plus its own notes in the
+        // unlocked ones, in time order whatever order the inputs come in (hand edits append). The
+        // kept notes are filtered out first and sorted only if they need it; then one merge pass.
+        // NoteArray is the processor's pattern (row/startTick/...); 'useRows' = false locks by bar
+        // only (melodic patterns).
+        template <typename NoteArray>
+        void splice(const NoteArray& current, NoteArray& generated, int barTicks, bool useRows) const
+        {
+            barTicks = juce::jmax(1, barTicks);
+            auto isLocked = [&](const auto& n)
+            {
+                return (useRows && rowLocked(n.row)) || barLocked(n.startTick / barTicks);
+            };
+            auto byTick = [](const auto& a, const auto& b) { return a.startTick < b.startTick; };
+
+            NoteArray kept, fresh;
+            kept.ensureStorageAllocated(current.size());
+            fresh.ensureStorageAllocated(generated.size());
+            for (const auto& n : current)   if (isLocked(n))  kept.add(n);
+            for (const auto& n : generated) if (!isLocked(n)) fresh.add(n); // generators never emit these; guard
+            if (!std::is_sorted(kept.begin(), kept.end(), byTick))   std::stable_sort(kept.begin(), kept.end(), byTick);
+            if (!std::is_sorted(fresh.begin(), fresh.end(), byTick)) std::stable_sort(fresh.begin(), fresh.end(), byTick);
+
+            generated.clearQuick();
+            generated.ensureStorageAllocated(kept.size() + fresh.size());
+            int i = 0, j = 0;
+            while (i < kept.size() || j < fresh.size())
+            {
+                if (j >= fresh.size() || (i < kept.size() && kept.getReference(i).startTick <= fresh.getReference(j).startTick))
+                    generated.add(kept.getReference(i++));
+                else
+                    generated.add(fresh.getReference(j++));
+            }
+        }
+    };
+}
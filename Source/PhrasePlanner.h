@@ -0,0 +1,65 @@
+#pragma once
+#include <JuceHeader.h>
+#include <cstdint>
+#include <vector>
+#include "BoomRandom.h"
+
+// Phrase planning shared by the generators: the first 1-2 bars (the cell) are generated in full,
+// every later bar is a copy of a cell bar plus the moves planned for it here (small / big
+// mutations and end-of-phrase fills). The plan is a few bytes per bar; the generators apply it.
+namespace boom::phrase
+{
+    // What happens to a copied bar; flags combine (a big mutation can also close a phrase)
+    enum Move : std::uint8_t
+    {
+        Copy  = 0,
+        Small = 1 << 0,   // one or two notes changed
+        Big   = 1 << 1,   // whole lanes swapped for another take
+        Fill  = 1 << 2    // last bar of a phrase
+    };
+
+    struct Cadence
+    {
+        int cellBars = 1;                // bars generated in full
+        int smallMin = 2, smallMax = 2;  // bars between small mutations (0 = never)
+        int bigEvery = 0;                // every Nth bar (1-based) gets a big mutation (0 = never)
+        int phraseBars = 4;              // the last bar of each phrase gets a fill (0 = never)
+    };
+
+    struct Bar
+    {
+        int source = 0;                  // cell bar this one copies
+        std::uint8_t moves = Copy;
+        bool isCell = false;             // generated in full, no moves
+    };
+
+    // Bar plan for 'bars' bars. Randomness is only drawn when the small cadence is a range
+    // (smallMin < smallMax), so fixed cadences leave the caller's Rng stream untouched.
+    inline void plan(const Cadence& c, int bars, boom::Rng& rng, std::vector<Bar>& out)
+    {
+        bars = juce::jmax(1, bars);
+        const int cellBars = juce::jlimit(1, bars, c.cellBars);
+        out.assign((size_t)bars, Bar {});
+
+        auto nextGap = [&]() -> int
+        {
+            if (c.smallMin <= 0) return 0;
+            return c.smallMax > c.smallMin ? rng.range(c.smallMin, c.smallMax) : c.smallMin;
+        };
+
+        int untilSmall = nextGap();
+        for (int bar = 0; bar < bars; ++bar)
+        {
+            const int pos = bar + 1;
+            Bar& b = out[(size_t)bar];
+            b.source = bar % cellBars;
+            b.isCell = bar < cellBars;
+
+            std::uint8_t moves = Copy;
+            if (untilSmall > 0 && --untilSmall == 0) { moves |= Small; untilSmall = nextGap(); }
+            if (c.bigEvery > 0 && pos % c.bigEvery == 0) moves |= Big;
+            if (c.phraseBars > 0 && pos % c.phraseBars == 0) moves |= Fill;
+            if (!b.isCell) b.moves = moves;
+        }
+    }
+}
@@ -17,7 +17,7 @@ void PianoRollComponent::setTimeSignature(int num, int den) noexcept
 
 void PianoRollComponent::setBarsToDisplay(int bars) noexcept
 {
-    bars = juce::jlimit(1, 64, bars);
+    bars = juce::jlimit(1, 128, bars);
     if (barsToDisplay_ != bars)
     {
         barsToDisplay_ = bars;
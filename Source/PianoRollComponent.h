@@ -10,6 +10,32 @@ public:
 
     void setPattern(const BoomAudioProcessor::Pattern& pat) { pattern = pat; repaint(); }
 
+    // Same as setPattern, but only repaints the area of the notes that changed. Patterns come in
+    // time order and a live slider move changes a few notes, so everything between the common
+    // prefix and the common suffix of the old and new pattern is the dirty part.
+    void updatePattern(const BoomAudioProcessor::Pattern& pat)
+    {
+        auto same = [](const BoomAudioProcessor::Note& a, const BoomAudioProcessor::Note& b)
+        {
+            return a.pitch == b.pitch && a.startTick == b.startTick && a.lengthTicks == b.lengthTicks;
+        };
+
+        const int n0 = pattern.size(), n1 = pat.size();
+        int head = 0;
+        while (head < n0 && head < n1 && same(pattern.getReference(head), pat.getReference(head))) ++head;
+        int tail = 0;
+        while (tail < n0 - head && tail < n1 - head
+               && same(pattern.getReference(n0 - 1 - tail), pat.getReference(n1 - 1 - tail))) ++tail;
+
+        juce::Rectangle<float> dirty;
+        for (int i = head; i < n0 - tail; ++i) dirty = dirty.getUnion(noteBounds(pattern.getReference(i)));
+        for (int i = head; i < n1 - tail; ++i) dirty = dirty.getUnion(noteBounds(pat.getReference(i)));
+
+        pattern = pat;
+        if (!dirty.isEmpty())
+            repaint(dirty.getSmallestIntegerContainer().expanded(1));
+    }
+
 public:
     void setTimeSignature(int num, int den = 4) noexcept;
     void setBarsToDisplay(int bars) noexcept;
@@ -26,12 +52,9 @@ public:
         g.fillAll(GridBackground());
 
 
-        const int bars = 4;                // grid visual only
-        const int stepsPerBar = 16;
-        const int cols = bars * stepsPerBar;
-
-        const int rows = 48;               // 4 octaves view
-        const int baseMidi = 36;           // C2 at bottom
+        const int cols = numCols();
+        const int rows = kRows;
+        const int baseMidi = kBaseMidi;
 
         int x = leftMargin_;
         for (int bar = 0; bar < barsToDisplay_; ++bar)
@@ -119,18 +142,71 @@ public:
         g.setColour(NoteFill());
         for (const auto& n : pattern)
         {
-            const int col = (n.startTick / 24) % cols;
-            const int row = juce::jlimit(0, rows - 1, rows - 1 - ((n.pitch - baseMidi) % rows));
-            const float w = cellW * juce::jmax(1, n.lengthTicks / 24) - 4.f;
-
-            g.fillRoundedRectangle(juce::Rectangle<float>(gridX + col * cellW + 2.f,
-                r.getY() + row * cellH + 2.f,
-                w,
-                cellH - 4.f), 4.f);
+            const auto nb = noteBounds(n);
+            if (!nb.isEmpty()) g.fillRoundedRectangle(nb, 4.f);
+        }
+
+        // --- locked bars (kept by Generate): shaded, tagged like a locked drum lane ---
+        const auto engine = processor.getEngineSafe();
+        if (engine == boom::Engine::Drums) return;
+        const auto& locks = processor.getLocks(engine);
+        const float ticksW = cellW / 24.0f;
+        const int barTicks = processor.getLockBarTicks(engine);
+        for (int bar = 0; bar * barTicks < cols * 24; ++bar)
+        {
+            if (!locks.barLocked(bar)) continue;
+            const float x0 = gridX + bar * barTicks * ticksW;
+            const float x1 = juce::jmin(gridX + gridW, x0 + barTicks * ticksW);
+            const juce::Rectangle<float> barR(x0, r.getY(), x1 - x0, r.getHeight());
+            g.setColour(juce::Colours::black.withAlpha(0.25f));
+            g.fillRect(barR);
+            g.setColour(juce::Colours::white);
+            g.setFont(juce::Font(11.0f, juce::Font::bold));
+            g.drawFittedText("LOCK", barR.withHeight((float)headerH_).reduced(4.0f, 0.0f).toNearestInt(), juce::Justification::centredRight, 1);
         }
     }
 
+    // Shift-click on the top band of a bar (the bar ruler): lock / unlock the bar for the engine on
+    // screen, so Generate re-rolls only the other bars
+    void mouseDown(const juce::MouseEvent& e) override
+    {
+        const auto engine = processor.getEngineSafe();
+        if (!e.mods.isShiftDown() || e.position.y >= (float)headerH_ || engine == boom::Engine::Drums) return;
+
+        auto r = getLocalBounds().toFloat();
+        const float kbW = juce::jmax(60.0f, r.getWidth() * 0.08f);
+        const float cellW = (r.getWidth() - kbW) / numCols();
+        if (e.position.x < r.getX() + kbW || cellW <= 0.0f) return;
+
+        const int tick = (int)((e.position.x - r.getX() - kbW) / cellW * 24.0f);
+        const int bar = tick / juce::jmax(1, processor.getLockBarTicks(engine));
+        processor.setBarLocked(engine, bar, !processor.getLocks(engine).barLocked(bar));
+        repaint();
+    }
+
 private:
+    static constexpr int kStepsPerBar = 16;    // one column per 16th
+    static constexpr int kRows = 48;           // 4 octaves view
+    static constexpr int kBaseMidi = 36;       // C2 at bottom
+
+    int numCols() const noexcept { return barsToDisplay_ * kStepsPerBar; }
+
+    // Where paint() draws a note; empty for notes outside the displayed bars (clipped, not wrapped)
+    juce::Rectangle<float> noteBounds(const BoomAudioProcessor::Note& n) const
+    {
+        const int col = n.startTick / 24;
+        if (n.startTick < 0 || col >= numCols()) return {};
+
+        auto r = getLocalBounds().toFloat();
+        const float kbW = juce::jmax(60.0f, r.getWidth() * 0.08f);
+        const float gridX = r.getX() + kbW;
+        const float cellW = (r.getWidth() - kbW) / numCols();
+        const float cellH = r.getHeight() / kRows;
+        const int row = juce::jlimit(0, kRows - 1, kRows - 1 - ((n.pitch - kBaseMidi) % kRows));
+        const float w = cellW * juce::jmax(1, n.lengthTicks / 24) - 4.f;
+        return { gridX + col * cellW + 2.f, r.getY() + row * cellH + 2.f, w, cellH - 4.f };
+    }
+
     BoomAudioProcessor& processor;
     BoomAudioProcessor::Pattern pattern;
 
@@ -34,9 +34,40 @@ private:
     std::function<void(double)>    onUiUpdate;
 };
 
+// Throttles slider moves to one request per frame: the first change fires at once (no frame of
+// delay when a drag starts), later ones within the frame ride along, and a trailing fire at the
+// end of the frame picks up the slider's final value.
+class LiveRegenDebouncer : private juce::Timer
+{
+public:
+    explicit LiveRegenDebouncer(std::function<void()> fire) : onFire(std::move(fire)) {}
+    ~LiveRegenDebouncer() override { stopTimer(); }
+
+    void poke()
+    {
+        if (isTimerRunning()) { pending = true; return; }
+        if (onFire) onFire();
+        startTimer(16); // ~one frame at 60 Hz
+    }
+
+private:
+    void timerCallback() override
+    {
+        if (!pending) { stopTimer(); return; } // quiet for a whole frame: the next poke fires at once
+        pending = false;
+        if (onFire) onFire();                  // timer keeps running: next fire a frame from now at the earliest
+    }
+
+    std::function<void()> onFire;
+    bool pending = false;
+};
+
 // Now that BpmPoller is complete, define the editor dtor here:
 BoomAudioProcessorEditor::~BoomAudioProcessorEditor()
 {
+    proc.onGenerated = nullptr;
+    proc.setVariationPrefetch(false);
+    liveRegen.reset();
     bpmPoller.reset();
 }
 
@@ -54,7 +85,7 @@ namespace {
 }
 
 // ======= small helper =======
-int BoomAudioProcessorEditor::barsFromBox(const juce::ComboBox& b) { return b.getSelectedId() == 2 ? 8 : 4; }
+int BoomAudioProcessorEditor::barsFromBox(const juce::ComboBox& b) { return juce::jmax(1, b.getText().getIntValue()); }
 
 int BoomAudioProcessorEditor::getBarsFromUI() const
 {
@@ -98,6 +129,14 @@ BoomAudioProcessorEditor::BoomAudioProcessorEditor(BoomAudioProcessor& p)
     bpmLockAtt = std::make_unique<juce::AudioProcessorValueTreeState::ButtonAttachment>(
         proc.apvts, "bpmLock", bpmLockChk);
 
+    // --- Live regeneration checkbox (same skin as BPM Lock) ---
+    addAndMakeVisible(liveRegenChk);
+    liveRegenChk.setClickingTogglesState(true);
+    boomui::setToggleImages(liveRegenChk, "checkBoxOffBtn", "checkBoxOnBtn");
+    liveRegenChk.setTooltip("LIVE: after a Generate, moving Rest, Swing, Triplet or Dotted re-runs the same pattern with the new setting.");
+    liveRegenAtt = std::make_unique<juce::AudioProcessorValueTreeState::ButtonAttachment>(
+        proc.apvts, "liveRegen", liveRegenChk);
+
     // Position – keep your existing coordinates if you already had them
     // (these numbers are just an example; do not copy if you already placed it)
 
@@ -252,11 +291,11 @@ BoomAudioProcessorEditor::BoomAudioProcessorEditor(BoomAudioProcessor& p)
 
     diceBtn.onClick = [this]
     {
-        int bars = 4;
-        if (auto* p = dynamic_cast<juce::AudioParameterInt*>(proc.apvts.getParameter("bars")))
-            bars = p->get();
+        const int bars = proc.getBars();
 
-        juce::Random r;
+        // Picks come from the key this roll's take uses (randomizeCurrentEngine draws it below), on
+        // their own sub-stream: one click consumes one key, so the prefetched takes stay in step
+        auto r = proc.peekSeedKey(boom::seed::Op::Randomize).rng(2);
 
         // time signature
         if (timeSigBox.getNumItems() > 0)
@@ -303,9 +342,10 @@ BoomAudioProcessorEditor::BoomAudioProcessorEditor(BoomAudioProcessor& p)
 
     barsBox.onChange = [this]
     {
-        const int bars = barsBox.getSelectedId(); // 1/2/4/8
+        const int bars = barsFromBox(barsBox);
         drumGrid.setBarsToDisplay(bars);
         pianoRoll.setBarsToDisplay(bars);
+        drumGrid.setPattern(proc.getDrumPattern()); // fill the bars that just came into view
         drumGridView.setViewPosition(0, 0);
         pianoRollView.setViewPosition(0, 0);
     };
@@ -322,9 +362,9 @@ BoomAudioProcessorEditor::BoomAudioProcessorEditor(BoomAudioProcessor& p)
             {
                 const auto eng = proc.getEngineSafe();
                 const int bars = barsFromBox(barsBox);
-                const int seed = (int)proc.apvts.getRawParameterValue("seed")->load();
-                if (eng == boom::Engine::Drums) proc.flipDrums(seed, density, bars);
-                else                             proc.flipMelodic(seed, density, bars);
+                // -1 = next Flip seed key (the "seed" param already feeds the session seed)
+                if (eng == boom::Engine::Drums) proc.flipDrums(-1, density, bars);
+                else                             proc.flipMelodic(-1, density, bars);
                 regenerate();
             },
             engine));
@@ -390,10 +430,35 @@ BoomAudioProcessorEditor::BoomAudioProcessorEditor(BoomAudioProcessor& p)
     // Bottom bar: Generate + Drag (ImageButtons)
     setButtonImages(btnGenerate, "generateBtn"); addAndMakeVisible(btnGenerate);
     setButtonImages(btnDragMidi, "dragBtn");     addAndMakeVisible(btnDragMidi);
-    btnGenerate.setTooltip("Generates MIDI patterns according to the ENGINE selected at the top, the choices in the boxes on the left, and the humanization sliders on the right!");
+    btnGenerate.setTooltip("Generates MIDI patterns according to the ENGINE selected at the top, the choices in the boxes on the left, and the humanization sliders on the right! Shift-click on Drums to keep the best of 256 grooves.");
     btnDragMidi.setTooltip("Allows you to drag and drop the MIDI you have generated into your DAW!");
     btnDragMidi.addMouseListener(this, true); // start drag on mouseDown
 
+    // Background generation results land here (message thread, pattern already applied).
+    // Only the changed cells / notes are repainted, so live slider updates stay within a frame.
+    proc.onGenerated = [this](boom::Engine e)
+    {
+        if (e == boom::Engine::Drums)
+            drumGrid.updatePattern(proc.getDrumPattern());
+        else
+            pianoRoll.updatePattern(proc.getMelodicPattern());
+    };
+
+    // Live regeneration: feel sliders re-run the last Drums / Bass generate with its seed
+    liveRegen = std::make_unique<LiveRegenDebouncer>([this]
+    {
+        if (proc.isLiveRegenerate())
+            proc.regenerateLive(proc.getEngineSafe());
+    });
+    for (auto* s : { &restDrums, &rest808, &swing, &tripletDensity, &dottedDensity })
+        s->onValueChange = [this]
+        {
+            if (proc.isLiveRegenerate()) liveRegen->poke();
+        };
+
+    // Keep the next Generate / Dice takes ready while the editor is open
+    proc.setVariationPrefetch(true);
+
     // === Correct Generate wiring that matches our existing Processor APIs ===
     btnGenerate.onClick = [this]
     {
@@ -408,9 +473,7 @@ BoomAudioProcessorEditor::BoomAudioProcessorEditor(BoomAudioProcessor& p)
         if (eng == boom::Engine::e808) // <-- use your exact enum value for 808
         {
             // --- pull UI params safely ---
-            int bars = 4;
-            if (auto* p = dynamic_cast<juce::AudioParameterInt*>(proc.apvts.getParameter("bars")))
-                bars = p->get();
+            const int bars = proc.getBars();
 
             int keyIndex = 0;
             if (auto* p = dynamic_cast<juce::AudioParameterChoice*>(proc.apvts.getParameter("key")))
@@ -451,108 +514,15 @@ BoomAudioProcessorEditor::BoomAudioProcessorEditor(BoomAudioProcessor& p)
             repaint();
             return;
         }
-        if (eng == boom::Engine::Bass)
-        {
-            // ---- STYLE from APVTS (AudioParameterChoice "style") ----
-            juce::String style = "trap";
-            if (auto* styleParam = proc.apvts.getParameter("style"))
-                if (auto* choice = dynamic_cast<juce::AudioParameterChoice*>(styleParam))
-                {
-                    const int idx = choice->getIndex();
-                    auto styles = boom::styleChoices();
-                    if (styles.size() > 0)
-                        style = styles[juce::jlimit(0, styles.size() - 1, idx)];
-                }
-
-            // ---- BARS from APVTS (AudioParameterInt "bars"), fallback 4 ----
-            int bars = 4;
-            if (auto* barsParam = proc.apvts.getParameter("bars"))
-                if (auto* pi = dynamic_cast<juce::AudioParameterInt*>(barsParam))
-                    bars = pi->get();
-
-            // ---- OCTAVE from APVTS (AudioParameterInt "octave"), fallback 0 ----
-            int octave = 0;
-            if (auto* octParam = proc.apvts.getParameter("octave"))
-                if (auto* pi = dynamic_cast<juce::AudioParameterInt*>(octParam))
-                    octave = pi->get();
-
-            // ---- DENSITIES from APVTS raw values (0..100 floats) ----
-            auto clampPct = [](float v) -> int { return juce::jlimit(0, 100, (int)juce::roundToInt(v)); };
-
-            int restPct = 0;
-            if (auto* rp = proc.apvts.getRawParameterValue("restDensity"))
-                restPct = clampPct(rp->load());
-
-            int dottedPct = 0;
-            if (auto* dp = proc.apvts.getRawParameterValue("dottedDensity"))
-                dottedPct = clampPct(dp->load());
-
-            int tripletPct = 0;
-            if (auto* tp = proc.apvts.getRawParameterValue("tripletDensity"))
-                tripletPct = clampPct(tp->load());
-
-            const int swingPct = 0; // hook your swing slider/param here later
-
-            // ---- Generate + refresh UI ----
-            proc.generateBassFromSpec(style, bars, octave, restPct, dottedPct, tripletPct, swingPct, /*seed*/ -1);
-            pianoRoll.setPattern(proc.getMelodicPattern());
-            pianoRoll.repaint();
-            repaint();
-            return;
-        }
-        if (eng == boom::Engine::Drums)
+        if (eng == boom::Engine::Bass || eng == boom::Engine::Drums)
         {
-            // ---- STYLE from APVTS
-            juce::String style = "trap";
-            if (auto* styleParam = proc.apvts.getParameter("style"))
-                if (auto* choice = dynamic_cast<juce::AudioParameterChoice*>(styleParam))
-                {
-                    const int idx = choice->getIndex();
-                    auto styles = boom::drums::styleNames();
-                    if (styles.size() > 0)
-                        style = styles[juce::jlimit(0, styles.size() - 1, idx)];
-                }
-
-            // ---- BARS from APVTS (fallback 4)
-            int bars = 4;
-            if (auto* barsParam = proc.apvts.getParameter("bars"))
-                if (auto* pi = dynamic_cast<juce::AudioParameterInt*>(barsParam))
-                    bars = pi->get();
-
-            // ---- DENSITIES from APVTS (0..100)
-            auto clampPct = [](float v) -> int { return juce::jlimit(0, 100, (int)juce::roundToInt(v)); };
-
-            int restPct = 0;
-            if (auto* rp = proc.apvts.getRawParameterValue("restDensity"))
-                restPct = clampPct(rp->load());
-
-            int dottedPct = 0;
-            if (auto* dp = proc.apvts.getRawParameterValue("dottedDensity"))
-                dottedPct = clampPct(dp->load());
-
-            int tripletPct = 0;
-            if (auto* tp = proc.apvts.getRawParameterValue("tripletDensity"))
-                tripletPct = clampPct(tp->load());
-
-            int swingPct = 0;
-            if (auto* sp = proc.apvts.getRawParameterValue("swing"))
-                swingPct = clampPct(sp->load());
-
-            // ---- Call database generator, convert to your processor pattern, refresh UI
-            boom::drums::DrumStyleSpec spec = boom::drums::getSpec(style);
-            boom::drums::DrumPattern pat;
-            boom::drums::generate(spec, bars, restPct, dottedPct, tripletPct, swingPct, /*seed*/ -1, pat);
-
-            // Convert to your processor's pattern container (row,start,len,vel @ 96 PPQ)
-            auto procPat = proc.getDrumPattern();
-            procPat.clearQuick();
-            for (const auto& n : pat)
-                procPat.add({ 0, n.row, n.startTick, n.lenTicks, n.vel }); // channel=0 per your earlier struct
-
-            proc.setDrumPattern(procPat);
-            drumGrid.setPattern(proc.getDrumPattern());
-            drumGrid.repaint();
-            repaint();
+            // ---- Generate on the worker (or straight from the variation cache); onGenerated refreshes the view ----
+            // Drums: sections over shared bar cells (up to 8 bars: one verse, i.e. a plain generate).
+            // Shift-click on Drums: keep the best of 256 candidates by groove score instead of a single draw.
+            auto req = proc.makeGenRequest(eng);
+            if (eng == boom::Engine::Drums && juce::ModifierKeys::currentModifiers.isShiftDown())
+                req.candidates = 256;
+            proc.requestGeneration(req);
             return;
         }
 
@@ -608,6 +578,7 @@ void BoomAudioProcessorEditor::resized()
     lockToBpmLbl.setBounds(S(95, 65, 100, 20));
     bpmLockChk.setBounds(S(200, 60, 24, 24));
     bpmLbl.setBounds(S(105, 85, 100, 20));
+    liveRegenChk.setBounds(S(230, 60, 24, 24));
 
 
     // Left Column
@@ -704,6 +675,7 @@ void BoomAudioProcessorEditor::updateTimeSigAndBars()
     pianoRoll.setTimeSignature(num, den);
     drumGrid.setBarsToDisplay(bars);
     pianoRoll.setBarsToDisplay(bars);
+    drumGrid.setPattern(proc.getDrumPattern()); // fill the bars that just came into view
 
     // Reset scroll so users see bar 1 when TS/bars change
     drumGridView.setViewPosition(0, 0);
@@ -846,16 +818,34 @@ BoomAudioProcessor::Pattern BoomAudioProcessorEditor::makeDemoPatternMelodic(int
     return pat;
 }
 
+// Drum notes for MIDI export. A long form is expanded section by section straight from its shared
+// bar cells; otherwise the pattern is copied as is.
+static boom::midi::DrumPattern drumExportPattern(const BoomAudioProcessor& proc)
+{
+    boom::midi::DrumPattern mp;
+    const auto& form = proc.getDrumForm();
+    if (!form.empty())
+    {
+        form.forEachNote(0, form.totalBars() * form.barTicks, [&](const BoomAudioProcessor::Note& n, int tick)
+        {
+            mp.add({ n.row, tick, n.lengthTicks, n.velocity });
+        });
+        return mp;
+    }
+
+    mp.ensureStorageAllocated(proc.getDrumPattern().size());
+    for (const auto& n : proc.getDrumPattern())
+        mp.add({ n.row, n.startTick, n.lengthTicks, n.velocity });
+    return mp;
+}
+
 juce::File BoomAudioProcessorEditor::writeTempMidiFile() const
 {
     auto engine = (boom::Engine)(int)proc.apvts.getRawParameterValue("engine")->load();
     juce::MidiFile mf;
     if (engine == boom::Engine::Drums)
     {
-        boom::midi::DrumPattern mp;
-        for (const auto& n : proc.getDrumPattern())
-            mp.add({ n.row, n.startTick, n.lengthTicks, n.velocity });
-        mf = boom::midi::buildMidiFromDrums(mp, 96);
+        mf = boom::midi::buildMidiFromDrums(drumExportPattern(proc), 96);
     }
     else
     {
@@ -925,7 +915,7 @@ AIToolsWindow::AIToolsWindow(BoomAudioProcessor& p, std::function<void()> onClos
     // --- group wiring (add AFTER you’ve created the controls) ---
     addToGroup(rhythmimickGroup, {
         &rhythmimickLbl, &rhythmimickDescLbl, &recordUpTo60LblTop,
-        &btnRec1, &btnStop1, &btnGen1, &btnSave1, &btnDrag1, &toggleRhythm
+        &btnRec1, &btnStop1, &btnGen1, &btnSave1, &btnDrag1, &toggleRhythm, &previewClick1, &barSync1, &loopRec1, &drumsOnly1
         });
 
     addToGroup(slapsmithGroup, {
@@ -941,7 +931,7 @@ AIToolsWindow::AIToolsWindow(BoomAudioProcessor& p, std::function<void()> onClos
 
     addToGroup(beatboxGroup, {
         &beatboxLbl, &beatboxDescLbl, &recordUpTo60LblBottom,
-        &btnRec4, &btnStop4, &btnGen4, &btnSave4, &btnDrag4, &toggleBeat
+        &btnRec4, &btnStop4, &btnGen4, &btnSave4, &btnDrag4, &toggleBeat, &previewClick4, &barSync4, &loopRec4, &drumsOnly4
         });
 
 
@@ -1012,6 +1002,12 @@ AIToolsWindow::AIToolsWindow(BoomAudioProcessor& p, std::function<void()> onClos
     blendAB.setValue(50.0);
 
     blendAB.setTooltip("Blends two styles together to make interesting MIDI patterns!");
+    blendAB.onValueChange = [this]
+    {
+        // Live re-blend of the last StyleBlender groove (blended specs are cached, so this is cheap)
+        if (blendSeed >= 0 && activeTool_ == Tool::StyleBlender)
+            runStyleBlend();
+    };
 
 
     addAndMakeVisible(rhythmSeek);
@@ -1033,7 +1029,7 @@ AIToolsWindow::AIToolsWindow(BoomAudioProcessor& p, std::function<void()> onClos
     {
         if (proc.aiHasCapture()) proc.aiPreviewStart();
     };
-    btnRec1.onClick = [this] { proc.aiStartCapture(BoomAudioProcessor::CaptureSource::Loopback); };
+    btnRec1.onClick = [this] { startRecording(BoomAudioProcessor::CaptureSource::Loopback); };
     btnStop1.onClick = [this] { proc.aiStopCapture(); };
 
     addAndMakeVisible(beatboxSeek);
@@ -1055,10 +1051,54 @@ AIToolsWindow::AIToolsWindow(BoomAudioProcessor& p, std::function<void()> onClos
     {
         if (proc.aiHasCapture()) proc.aiPreviewStart();
     };
-    btnRec4.onClick = [this] { proc.aiStartCapture(BoomAudioProcessor::CaptureSource::Microphone); };
+    btnRec4.onClick = [this] { startRecording(BoomAudioProcessor::CaptureSource::Microphone); };
     btnStop4.onClick = [this] { proc.aiStopCapture(); };
     beatboxSeek.setEnabled(false);
 
+    // Beat click over the preview so you can hear whether the transcription grid lines up
+    for (auto* chk : { &previewClick1, &previewClick4 })
+    {
+        addAndMakeVisible(*chk);
+        boomui::setToggleImages(*chk, "checkBoxOffBtn", "checkBoxOnBtn");
+        chk->setToggleState(proc.aiIsPreviewClickEnabled(), juce::dontSendNotification);
+        chk->setTooltip("Play a click on every beat while previewing your recording, so you can hear if the pattern lines up.");
+    }
+    previewClick1.onClick = [this]
+    {
+        proc.aiSetPreviewClick(previewClick1.getToggleState());
+        previewClick4.setToggleState(previewClick1.getToggleState(), juce::dontSendNotification);
+    };
+    previewClick4.onClick = [this]
+    {
+        proc.aiSetPreviewClick(previewClick4.getToggleState());
+        previewClick1.setToggleState(previewClick4.getToggleState(), juce::dontSendNotification);
+    };
+
+    // Bar sync / loop record: both rows share one setting, so keep each pair mirrored
+    auto mirrorPair = [this](juce::ImageButton& a, juce::ImageButton& b, const juce::String& tip)
+    {
+        for (auto* chk : { &a, &b })
+        {
+            addAndMakeVisible(*chk);
+            boomui::setToggleImages(*chk, "checkBoxOffBtn", "checkBoxOnBtn");
+            chk->setTooltip(tip);
+        }
+        a.onClick = [&a, &b] { b.setToggleState(a.getToggleState(), juce::dontSendNotification); };
+        b.onClick = [&a, &b] { a.setToggleState(b.getToggleState(), juce::dontSendNotification); };
+    };
+    mirrorPair(barSync1, barSync4, "Wait for your DAW: recording starts on the next bar once the transport is playing, so the take lines up with your song.");
+    mirrorPair(loopRec1, loopRec4, "Loop record: every pass of the selected bar count is kept as its own take. Generate keeps the hits most passes agree on.");
+
+    // Drums-only listening is a parameter, so both rows simply attach to it
+    for (auto* chk : { &drumsOnly1, &drumsOnly4 })
+    {
+        addAndMakeVisible(*chk);
+        boomui::setToggleImages(*chk, "checkBoxOffBtn", "checkBoxOnBtn");
+        chk->setTooltip("Drums-only listening: ignore bass notes, vocals and pads in a full mix so they don't turn into kicks and snares.");
+    }
+    drumsOnlyAtt1 = std::make_unique<juce::AudioProcessorValueTreeState::ButtonAttachment>(proc.apvts, "hpssEnabled", drumsOnly1);
+    drumsOnlyAtt4 = std::make_unique<juce::AudioProcessorValueTreeState::ButtonAttachment>(proc.apvts, "hpssEnabled", drumsOnly4);
+
     auto saveMidi = [this](const juce::String& defaultBase)
     {
         juce::File src = buildTempMidi(defaultBase); // you already have a version of this
@@ -1177,9 +1217,7 @@ AIToolsWindow::AIToolsWindow(BoomAudioProcessor& p, std::function<void()> onClos
 
     btnGen2.onClick = [this]
     {
-        int bars = 4;
-        if (auto* p = dynamic_cast<juce::AudioParameterInt*>(proc.apvts.getParameter("bars")))
-            bars = p->get();
+        const int bars = proc.getBars();
 
         proc.aiSlapsmithExpand(bars);
         miniGrid.setPattern(proc.getDrumPattern());
@@ -1188,21 +1226,8 @@ AIToolsWindow::AIToolsWindow(BoomAudioProcessor& p, std::function<void()> onClos
 
     btnGen3.onClick = [this]
     {
-        const juce::String a = styleABox.getText();
-        const juce::String b = styleBBox.getText();
-
-        int bars = 4;
-        if (auto* p = dynamic_cast<juce::AudioParameterInt*>(proc.apvts.getParameter("bars")))
-            bars = p->get();
-
-        const float wA = (float)juce::jlimit(0, 100, (int)juce::roundToInt(blendAB.getValue())) / 100.0f;
-        const float wB = 1.0f - wA;
-
-        proc.aiStyleBlendDrums(a, b, bars, wA, wB);
-
-        // refresh main grid from processor
-        miniGrid.setPattern(proc.getDrumPattern());
-        miniGrid.repaint();
+        blendSeed = -1; // new groove
+        runStyleBlend();
     };
 
     btnGen4.onClick = [this] {                // Beatbox: analyze captured mic → drums
@@ -1252,10 +1277,35 @@ AIToolsWindow::AIToolsWindow(BoomAudioProcessor& p, std::function<void()> onClos
     startTimerHz(20); // ~50ms updates; smooth enough
 }
 
+void AIToolsWindow::runStyleBlend()
+{
+    const juce::String a = styleABox.getText();
+    const juce::String b = styleBBox.getText();
+    const int bars = proc.getBars();
+
+    const float wA = (float)juce::jlimit(0, 100, (int)juce::roundToInt(blendAB.getValue())) / 100.0f;
+    const float wB = 1.0f - wA;
+
+    proc.aiStyleBlendDrums(a, b, bars, wA, wB, blendSeed);
+    if (blendSeed < 0)
+        blendSeed = proc.getLastSeedKey().toInt();
+
+    // refresh main grid from processor
+    miniGrid.setPattern(proc.getDrumPattern());
+    miniGrid.repaint();
+}
+
 void AIToolsWindow::timerCallback()
 {
+    proc.aiUpdateWaveform();   // fold in whatever was recorded since the last tick
     updateSeekFromProcessor();
 
+    if (proc.getDrumPatternVersion() != shownDrumVersion)
+    {
+        shownDrumVersion = proc.getDrumPatternVersion();
+        miniGrid.setPattern(proc.getDrumPattern());
+    }
+
     const float l = proc.getInputRMSL();
     const float r = proc.getInputRMSR();
 
@@ -1276,17 +1326,30 @@ void AIToolsWindow::timerCallback()
     if (activeTool_ == Tool::Rhythmimick)
     {
         btnPlay1.setEnabled(hasCap);
-        btnStop1.setEnabled(hasCap || proc.aiIsCapturing());
+        btnStop1.setEnabled(hasCap || proc.aiIsCapturing() || proc.aiIsCaptureArmed());
         rhythmSeek.setEnabled(hasCap);
+        btnGen1.setEnabled(!proc.aiIsTranscribing()); // the take is still being analyzed
     }
     if (activeTool_ == Tool::Beatbox)
     {
         btnPlay4.setEnabled(hasCap);
-        btnStop4.setEnabled(hasCap || proc.aiIsCapturing());
+        btnStop4.setEnabled(hasCap || proc.aiIsCapturing() || proc.aiIsCaptureArmed());
         beatboxSeek.setEnabled(hasCap);
+        btnGen4.setEnabled(!proc.aiIsTranscribing());
     }
 }
 
+void AIToolsWindow::startRecording(BoomAudioProcessor::CaptureSource src)
+{
+    // Loop takes only make sense on the host timeline, so looping implies bar sync
+    if (loopRec1.getToggleState())
+        proc.aiArmCapture(src, proc.getBars());
+    else if (barSync1.getToggleState())
+        proc.aiArmCapture(src);
+    else
+        proc.aiStartCapture(src);
+}
+
 void AIToolsWindow::updateSeekFromProcessor()
 {
     if (!proc.aiHasCapture())
@@ -1416,6 +1479,42 @@ void AIToolsWindow::paint(juce::Graphics& g)
 
     drawMeter(leftM, levelL);
     drawMeter(rightM, levelR);
+
+    // Waveform overview behind both seek bars (they mirror the same capture): one min/max pair per pixel
+    // from the processor's pyramid, then the detected onsets coloured by drum row.
+    const int lenS = proc.getCaptureLengthSamples();
+    if (lenS > 0)
+    {
+        for (auto* seek : { &rhythmSeek, &beatboxSeek })
+        {
+            const auto area = seek->getBounds();
+            const int w = area.getWidth();
+            if (w <= 0) continue;
+
+            const float midY = (float)area.getCentreY();
+            const float halfH = area.getHeight() * 0.5f;
+
+            g.setColour(boomtheme::WaveformFill().withAlpha(seek->isEnabled() ? 0.9f : 0.35f));
+            for (int px = 0; px < w; ++px)
+            {
+                const int s0 = (int)((juce::int64)lenS * px / w);
+                const int s1 = juce::jmax(s0 + 1, (int)((juce::int64)lenS * (px + 1) / w));
+                float mn = 0.0f, mx = 0.0f;
+                proc.aiGetWaveformRange(s0, s1, mn, mx);
+                const float top = midY - juce::jlimit(-1.0f, 1.0f, mx) * halfH;
+                const float bottom = midY - juce::jlimit(-1.0f, 1.0f, mn) * halfH;
+                g.drawVerticalLine(area.getX() + px, top, juce::jmax(top + 1.0f, bottom));
+            }
+
+            for (const auto& o : proc.aiGetCaptureOnsets())
+            {
+                if (!juce::isPositiveAndBelow(o.sample, lenS)) continue;
+                const int x = area.getX() + (int)((juce::int64)o.sample * w / lenS);
+                g.setColour(boomtheme::DrumRowColour(o.row));
+                g.drawVerticalLine(x, (float)area.getY(), (float)area.getBottom());
+            }
+        }
+    }
     // If you want a full static background, uncomment:
     // g.drawImageWithin(loadSkin("aiToolsWindowMockUp.png"), 0, 0, getWidth(), getHeight(), juce::RectanglePlacement::fillDestination);
 }
@@ -1451,6 +1550,10 @@ void AIToolsWindow::resized()
     btnPlay1.setBounds(S(360, y + 85, 30, 30));
     rhythmSeek.setBounds(S(400, y + 85, 140, 30));
     btnStop1.setBounds(S(550, y + 85, 30, 30));
+    previewClick1.setBounds(S(588, y + 88, 24, 24));
+    barSync1.setBounds(S(620, y + 88, 24, 24));
+    loopRec1.setBounds(S(652, y + 88, 24, 24));
+    drumsOnly1.setBounds(S(684, y + 88, 24, 24));
     btnGen1.setBounds(S(320, y + 120, 90, 30));
     btnSave1.setBounds(S(420, y + 120, 90, 30));
     btnDrag1.setBounds(S(520, y + 120, 90, 30));
@@ -1487,6 +1590,10 @@ void AIToolsWindow::resized()
     btnPlay4.setBounds(S(360, y + 85, 30, 30));
     beatboxSeek.setBounds(S(400, y + 85, 140, 30));
     btnStop4.setBounds(S(550, y + 85, 30, 30));
+    previewClick4.setBounds(S(588, y + 88, 24, 24));
+    barSync4.setBounds(S(620, y + 88, 24, 24));
+    loopRec4.setBounds(S(652, y + 88, 24, 24));
+    drumsOnly4.setBounds(S(684, y + 88, 24, 24));
     btnGen4.setBounds(S(320, y + 120, 90, 30));
     btnSave4.setBounds(S(420, y + 120, 90, 30));
     btnDrag4.setBounds(S(520, y + 120, 90, 30));
@@ -1501,10 +1608,7 @@ juce::File AIToolsWindow::buildTempMidi(const juce::String& base) const
     juce::MidiFile mf;
     if (engine == boom::Engine::Drums)
     {
-        boom::midi::DrumPattern mp;
-        for (const auto& n : proc.getDrumPattern())
-            mp.add({ n.row, n.startTick, n.lengthTicks, n.velocity });
-        mf = boom::midi::buildMidiFromDrums(mp, 96);
+        mf = boom::midi::buildMidiFromDrums(drumExportPattern(proc), 96);
     }
     else
     {
@@ -1657,10 +1761,7 @@ juce::File FlippitWindow::buildTempMidi() const
 
     if (engine == boom::Engine::Drums)
     {
-        boom::midi::DrumPattern mp;
-        for (const auto& n : proc.getDrumPattern())
-            mp.add({ n.row, n.startTick, n.lengthTicks, n.velocity });
-        mf = boom::midi::buildMidiFromDrums(mp, 96);
+        mf = boom::midi::buildMidiFromDrums(drumExportPattern(proc), 96);
     }
     else
     {
@@ -1842,12 +1943,16 @@ RollsWindow::RollsWindow(BoomAudioProcessor& p, std::function<void()> onClose, s
 
     diceBtn.onClick = [this]
     {
+        // Picks come from the key the triggered generate uses (generateRolls draws it), on a
+        // sub-stream of their own, so the roll still consumes one key and replays like any generate
+        auto r = proc.peekSeedKey(boom::seed::Op::Rolls).rng(1);
+
         // random style in the box
         const int n = styleBox.getNumItems();
-        if (n > 0) styleBox.setSelectedId(1 + juce::Random::getSystemRandom().nextInt(n));
+        if (n > 0) styleBox.setSelectedId(1 + r.nextInt(n));
 
         // random bars choice
-        barsBox.setSelectedId(1 + juce::Random::getSystemRandom().nextInt(4));
+        barsBox.setSelectedId(1 + r.nextInt(4));
 
         // trigger a generate
         btnGenerate.triggerClick();
@@ -1971,10 +2076,7 @@ void RollsWindow::resized()
 juce::File RollsWindow::buildTempMidi() const
 {
     juce::MidiFile mf;
-    boom::midi::DrumPattern mp;
-    for (const auto& n : proc.getDrumPattern())
-        mp.add({ n.row, n.startTick, n.lengthTicks, n.velocity });
-    mf = boom::midi::buildMidiFromDrums(mp, 96);
+    mf = boom::midi::buildMidiFromDrums(drumExportPattern(proc), 96);
 
     auto tmp = juce::File::getSpecialLocation(juce::File::tempDirectory).getChildFile("BOOM_Roll.mid");
     boom::midi::writeMidiToFile(mf, tmp);
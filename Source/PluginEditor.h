@@ -79,6 +79,7 @@ class BumppitWindow;
 class RollsWindow;
 class AIToolsWindow;
 class BpmPoller; 
+class LiveRegenDebouncer;
 
 class BoomAudioProcessorEditor : public juce::AudioProcessorEditor,
     public juce::DragAndDropContainer
@@ -109,6 +110,7 @@ public:
 
 private:
     std::unique_ptr<BpmPoller> bpmPoller;
+    std::unique_ptr<LiveRegenDebouncer> liveRegen;   // feel sliders -> at most one live regenerate per frame
     std::unique_ptr<juce::TooltipWindow> tooltipWindow;
     // Layout helpers
     static int barsFromBox(const juce::ComboBox& b);
@@ -116,6 +118,10 @@ private:
     using BAttachment = juce::AudioProcessorValueTreeState::ButtonAttachment;
     std::unique_ptr<BAttachment> bpmLockAtt;
 
+    // Live regeneration toggle ("liveRegen"): feel sliders re-run the last generate with its seed
+    juce::ImageButton liveRegenChk;
+    std::unique_ptr<BAttachment> liveRegenAtt;
+
     // Timer tick used to refresh the BPM tex
     void setEngine(boom::Engine e);
     void syncVisibility();
@@ -325,6 +331,11 @@ private:
     void setGroupEnabled(const juce::Array<juce::Component*>& group, bool enabled, float dimAlpha = 0.35f);
     void uncheckAllToggles();
 
+    // StyleBlender: Generate picks a fresh seed; dragging the blend slider afterwards regenerates
+    // with that same seed, so only the blend changes
+    int blendSeed = -1;
+    void runStyleBlend();
+
 
     juce::File saveWithChooserOrDesktop(const juce::String& baseName, const juce::File& srcTemp)
     {
@@ -368,6 +379,13 @@ private:
     // Style Blender controls
     juce::Slider      rhythmSeek;
     juce::Slider      beatboxSeek;
+    juce::ImageButton previewClick1, previewClick4; // beat click over the capture preview
+    juce::ImageButton barSync1, barSync4;           // arm: start recording on the next host bar line
+    juce::ImageButton loopRec1, loopRec4;           // loop-record one layer per pass of the current bar count
+    juce::ImageButton drumsOnly1, drumsOnly4;       // "hpssEnabled": strip harmonic content before transcribing
+    std::unique_ptr<juce::AudioProcessorValueTreeState::ButtonAttachment> drumsOnlyAtt1, drumsOnlyAtt4;
+
+    void startRecording(BoomAudioProcessor::CaptureSource src);
 
     void makeToolActive(Tool t);  // turns one on, others off
 
@@ -379,6 +397,7 @@ private:
     void performFileDrag(const juce::File& f);
 
     float  levelL{ 0.0f }, levelR{ 0.0f };
+    std::uint32_t shownDrumVersion = 0; // transcriptions land asynchronously; the timer picks them up
     double playbackSeconds{ 0.0 }, lengthSeconds{ 0.0 };
 
 public:
@@ -1,13 +1,17 @@
 #include "PluginEditor.h"
 #include "FlipUtils.h"
-#include <random>
 #include "EngineDefs.h"
-#include <map>
 #include <vector>
 #include <algorithm> // for std::find
 #include <cstdint>  // for std::uint64_t
 #include "DrumStyles.h" 
+#include "DrumMerge.h"
+#include "RollEngine.h"
 #include "BassStyleDB.h"
+#include "OnsetDetection.h"
+#include "HarmonicPercussive.h"
+#include "BoomRandom.h"
+#include "ScaleEngine.h"
 #include "DrumGridComponent.h"
 
 using AP = juce::AudioProcessorValueTreeState;
@@ -42,6 +46,9 @@ static AP::ParameterLayout createLayout()
     p.push_back(std::make_unique<juce::AudioParameterBool>("useDotted", "Dotted Notes", false));
     p.push_back(std::make_unique<juce::AudioParameterFloat>("dottedDensity", "Dotted Density", juce::NormalisableRange<float>(0.f, 100.f), 0.f));
 
+    // Feel sliders re-run the last Drums/Bass generate with its seed while they move
+    p.push_back(std::make_unique<juce::AudioParameterBool>("liveRegen", "Live Regenerate", false));
+
     p.push_back(std::make_unique<juce::AudioParameterChoice>("key", "Key", boom::keyChoices(), 0));
     p.push_back(std::make_unique<juce::AudioParameterChoice>("scale", "Scale", boom::scaleChoices(), 0));
     p.push_back(std::make_unique<juce::AudioParameterChoice>("octave", "Octave", juce::StringArray("-2", "-1", "0", "+1", "+2"), 2));
@@ -54,6 +61,17 @@ static AP::ParameterLayout createLayout()
 
     p.push_back(std::make_unique<juce::AudioParameterInt>("seed", "Seed", 0, 1000000, 0));
 
+    // Rhythmimick / Beatbox onset sensitivity per drum row (higher = more hits detected)
+    p.push_back(std::make_unique<juce::AudioParameterFloat>("onsetSensKick", "Onset Sensitivity Kick", juce::NormalisableRange<float>(0.f, 100.f), 50.f));
+    p.push_back(std::make_unique<juce::AudioParameterFloat>("onsetSensSnare", "Onset Sensitivity Snare", juce::NormalisableRange<float>(0.f, 100.f), 50.f));
+    p.push_back(std::make_unique<juce::AudioParameterFloat>("onsetSensHat", "Onset Sensitivity Hat", juce::NormalisableRange<float>(0.f, 100.f), 50.f));
+
+    // Separate harmonic/percussive content before onset detection (for captures of a full mix)
+    p.push_back(std::make_unique<juce::AudioParameterBool>("hpssEnabled", "Drums-Only Listening", false));
+
+    // 808/Bass vs. the drum kicks: negative steers notes away from kicks, positive onto them, 0 = off
+    p.push_back(std::make_unique<juce::AudioParameterFloat>("kickCoupling", "Kick Coupling", juce::NormalisableRange<float>(-100.f, 100.f), 0.f));
+
 
     return { p.begin(), p.end() };
 }
@@ -106,7 +124,7 @@ void BoomAudioProcessor::generate808(const juce::String& style,
         return;
 
     // ---- Config & helpers ----
-    bars = juce::jlimit(1, 8, bars);
+    bars = juce::jlimit(1, 128, bars);
     densityPercent = juce::jlimit(0, 100, densityPercent);
 
     // time signature -> steps per bar
@@ -130,52 +148,21 @@ void BoomAudioProcessor::generate808(const juce::String& style,
     const int ppq = 96;                         // for export (not used here)
     const int totalSteps = stepsPerBar * bars;
 
-    // ---- Scale tables ----
-    static const std::map<juce::String, std::vector<int>, std::less<>> kScales = {
-        { "Major",          { 0,2,4,5,7,9,11 } },
-        { "Natural Minor",  { 0,2,3,5,7,8,10 } },
-        { "Harmonic Minor", { 0,2,3,5,7,8,11 } },
-        { "Dorian",         { 0,2,3,5,7,9,10 } },
-        { "Phrygian",       { 0,1,3,5,7,8,10 } },
-        { "Lydian",         { 0,2,4,6,7,9,11 } },
-        { "Mixolydian",     { 0,2,4,5,7,9,10 } },
-        { "Aeolian",        { 0,2,3,5,7,8,10 } },
-        { "Locrian",        { 0,1,3,5,6,8,10 } },
-        { "Blues",          { 0,3,5,6,7,10 } },
-        { "Pentatonic Maj", { 0,2,4,7,9 } },
-        { "Pentatonic Min", { 0,3,5,7,10 } },
-        { "Chromatic",      { 0,1,2,3,4,5,6,7,8,9,10,11 } }
-    };
     static const juce::StringArray kKeys = { "C","C#","D","D#","E","F","F#","G","G#","A","A#","B" };
 
     auto keyIndex = juce::jmax(0, kKeys.indexOf(keyName.trim().toUpperCase()));
-    const auto itScale = kScales.find(scaleName.trim());
-    const auto& scalePCs = (itScale != kScales.end()) ? itScale->second : kScales.at("Chromatic");
-
-    auto wrap12 = [](int v) { v %= 12; if (v < 0) v += 12; return v; };
+    const int scaleId = boom::scale::fromName(scaleName);
 
     auto degreeToPitch = [&](int degree, int octave)->int
     {
-        // degree is index in scalePCs (wrap), root = keyIndex
-        const int pc = scalePCs[(degree % (int)scalePCs.size() + (int)scalePCs.size()) % (int)scalePCs.size()];
-        return juce::jlimit(0, 127, octave * 12 + wrap12(keyIndex + pc));
+        // degree wraps within the scale, root = keyIndex
+        return juce::jlimit(0, 127, octave * 12 + boom::scale::wrap12(keyIndex + boom::scale::interval(scaleId, degree)));
     };
 
-    // ---- Randomness (never same twice) ----
-    // Mix in a monotonic nonce so even same UI values differ each time
-// Robust seed: mix 32-bit millis, 64-bit hi-res ticks, and a monotonic nonce
-    const auto now32 = juce::Time::getMillisecondCounter();      // uint32
-    const auto ticks64 = (std::uint64_t)juce::Time::getHighResolutionTicks();
-    const auto nonce = genNonce_.fetch_add(1, std::memory_order_relaxed) + 1; // or ++genNonce_ if not atomic
-
-    const std::uint64_t mix = (std::uint64_t)now32
-        ^ (ticks64)
-        ^ (std::uint64_t)nonce;
-
-    // keep it in signed-int range for juce::Random
-    const int seed = (int)(mix & 0x7fffffff);
-    juce::Random rng(seed);
-    auto pct = [&](int prob)->bool { return rng.nextInt({ 100 }) < juce::jlimit(0, 100, prob); };
+    // ---- Randomness: a fresh seed key per call (counter advances), reproducible from the key ----
+    const int seed = nextSeed(boom::seed::Op::Generate);
+    boom::Rng rng((std::uint64_t)(std::uint32_t)seed);
+    auto pct = [&](int prob)->bool { return rng.below(100) < juce::jlimit(0, 100, prob); };
 
     // ---- Clear melodic pattern, we’re generating fresh 808s ----
     auto mp = getMelodicPattern();
@@ -267,7 +254,7 @@ void BoomAudioProcessor::generate808(const juce::String& style,
         const int startTick = step * tps;
         const int lenTick = juce::jmax(6, lenSteps * tps);
         const int pitch = degreeToPitch(currentDegree, currentOct);
-        mp.add({ pitch, startTick, lenTick, juce::jlimit(1,127,vel), 1 });
+        mp.add({ pitch, 0, startTick, lenTick, juce::jlimit(1,127,vel), 1 });
     };
 
     for (int step = 0; step < totalSteps; )
@@ -293,7 +280,7 @@ void BoomAudioProcessor::generate808(const juce::String& style,
                 const int subTick = juce::jmax(3, juce::jmin(sub, endT - t));
                 int v = 90 + rng.nextInt({ 25 });
                 int pitch = degreeToPitch(localDeg, currentOct);
-                mp.add({ pitch, t, subTick, juce::jlimit(1,127,v), 1 });
+                mp.add({ pitch, 0, t, subTick, juce::jlimit(1,127,v), 1 });
 
                 // occasionally nudge degree
                 if (pct(35)) localDeg += (rng.nextBool() ? +1 : -1);
@@ -329,151 +316,22 @@ void BoomAudioProcessor::generate808(const juce::String& style,
 
 
 
-// ============================================================
-// Bass Generator – rhythm-first, style-weighted, variety-safe.
-// ============================================================
-
-namespace
-{
-    // 96 ticks/quarter => 24 per 1/16 (you already use this grid elsewhere)
-    constexpr int kTicksPerQuarter = 96;
-    constexpr int kTicksPer16 = kTicksPerQuarter / 4;
-
-    struct BassStyleSpec
-    {
-        // Weight maps per 1/16th within a 1-bar cell (size 16)
-        // Higher number => more likely to place an onset there
-        int weight16[16];
-
-        // Probability (0..1) of subdividing a chosen onset into two 1/32s
-        float splitTo32Prob;
-
-        // Density scaler (0..1) used as baseline before restPct is applied
-        float baseDensity;
-
-        // Syncopation bias: + pushes off-beats, - pushes on-beats
-        float syncBias; // -1..+1
-    };
-
-    // A tiny per-style table. You can extend/replace with your database easily.
-    // We’re mapping by lowercase style name.
-    BassStyleSpec getBassStyleSpec(const juce::String& styleLower)
-    {
-        // Defaults: “pop-ish”
-        BassStyleSpec s = {
-            /*weight16*/ { 9,2,4,2,  8,3,4,3,  9,2,4,2,  8,3,4,3 },
-            /*split*/     0.10f,
-            /*density*/   0.55f,
-            /*sync*/      0.10f
-        };
-
-        if (styleLower == "trap")
-        {
-            BassStyleSpec t = {
-                // On-beats + 8th feel + room for syncopation
-                { 10,3,7,3,  9,3,7,3,  10,3,7,3,  9,3,7,3 },
-                0.25f,  // occasional 1/32 “bop”
-                0.65f,  // fairly dense
-                0.15f
-            };
-            return t;
-        }
-        if (styleLower == "drill")
-        {
-            BassStyleSpec d = {
-                // Triplet-heavy feel approximated by pushing 3,7,11,15
-                { 7,3,9,2,  6,3,9,2,  7,3,9,2,  6,3,9,2 },
-                0.30f,
-                0.55f,
-                0.25f  // more off-beat bias
-            };
-            return d;
-        }
-        if (styleLower == "wxstie")
-        {
-            BassStyleSpec w = {
-                // Sparser + unpredictable; keep on-beats okay, push some off-beats
-                { 10,2,5,2,  8,2,6,2,  10,2,5,2,  8,2,6,2 },
-                0.20f,
-                0.45f, // sparser baseline
-                0.35f  // stronger syncopation preference
-            };
-            return w;
-        }
-        if (styleLower == "hip hop" || styleLower == "hiphop")
-        {
-            BassStyleSpec h = {
-                { 10,2,4,2,  8,2,5,2,  10,2,4,2,  8,2,5,2 },
-                0.12f,
-                0.55f,
-                0.05f
-            };
-            return h;
-        }
-        if (styleLower == "r&b" || styleLower == "rnb")
-        {
-            BassStyleSpec r = {
-                // More space + occasional anticipations
-                { 9,2,5,2,  7,2,5,2,  9,2,5,2,  7,2,5,2 },
-                0.15f,
-                0.45f,
-                0.10f
-            };
-            return r;
-        }
-        if (styleLower == "edm")
-        {
-            BassStyleSpec e = {
-                // Four-on-the-floor support w/ 8th push
-                { 10,3,6,3,  9,3,6,3,  10,3,6,3,  9,3,6,3 },
-                0.18f,
-                0.60f,
-                -0.05f  // bias *toward* on-beats
-            };
-            return e;
-        }
-        if (styleLower == "reggaeton")
-        {
-            BassStyleSpec g = {
-                // DemBow-ish: emphasize 1, “and” of 2, and 4-ish positions
-                { 11,2,5,2,  7,9,4,2,  10,2,5,2,  7,8,4,2 },
-                0.12f,
-                0.55f,
-                0.20f
-            };
-            return g;
-        }
-        if (styleLower == "rock")
-        {
-            BassStyleSpec k = {
-                // Straighter, on-beat support; fewer syncopations
-                { 11,2,4,2,  9,2,4,2,  11,2,4,2,  9,2,4,2 },
-                0.08f,
-                0.50f,
-                -0.10f
-            };
-            return k;
-        }
-
-        return s; // default
-    }
-
-    static inline float urand01(juce::Random& rng) { return rng.nextFloat(); }
-}
-
-
-void BoomAudioProcessor::aiStyleBlendDrums(const juce::String& styleA, const juce::String& styleB, int bars, float wA, float wB)
+void BoomAudioProcessor::aiStyleBlendDrums(const juce::String& styleA, const juce::String& styleB, int bars, float wA, float wB, int seed)
 {
     // Normalize weights
     wA = std::max(0.0f, wA);
     wB = std::max(0.0f, wB);
     const float sum = (wA + wB > 0.0001f ? (wA + wB) : 1.0f);
-    wA /= sum; wB /= sum;
+    wB /= sum;
 
-    // Pick A vs B by weight
-    std::random_device rd; std::mt19937 rng(rd());
-    std::uniform_real_distribution<float> coin(0.0f, 1.0f);
-    const juce::String chosen = (coin(rng) < wA ? styleA : styleB);
+    // Resolve both styles; with only one known, that one gets the whole weight
+    boom::drums::StyleId idA, idB;
+    const bool knownA = boom::drums::findStyle(styleA, idA);
+    const bool knownB = boom::drums::findStyle(styleB, idB);
+    if (!knownA && !knownB)
+        return; // unknown styles; bail quietly
+    if (!knownA) idA = idB;
+    if (!knownB) idB = idA;
 
     // Pull global “feel” from sliders
     const int restPct = getPct(apvts, "restDensity", 0);
@@ -481,14 +339,11 @@ void BoomAudioProcessor::aiStyleBlendDrums(const juce::String& styleA, const juc
     const int tripletPct = getPct(apvts, "tripletDensity", 0);
     const int swingPct = getPct(apvts, "swing", 0);
 
-    // Generate drums via your style DB
-    auto styles = boom::drums::styleNames();
-    if (!styles.contains(chosen))
-        return; // unknown style; bail quietly
-
-    boom::drums::DrumStyleSpec spec = boom::drums::getSpec(chosen);
+    // Generate from the interpolated spec (cached per pair and weight step). Passing the same seed
+    // again while the slider moves keeps the groove and only changes the blend.
     boom::drums::DrumPattern pat;
-    boom::drums::generate(spec, bars, restPct, dottedPct, tripletPct, swingPct, /*seed*/ -1, pat);
+    boom::drums::generate(boom::drums::blendedSpec(idA, idB, wB), bars, restPct, dottedPct, tripletPct, swingPct,
+        resolveSeed(seed, boom::seed::Op::StyleBlend), pat);
 
     // Convert DB pattern -> processor’s DrumNote array
     BoomAudioProcessor::Pattern out;
@@ -505,6 +360,50 @@ void BoomAudioProcessor::aiStyleBlendDrums(const juce::String& styleA, const juc
     setDrumPattern(out);
 }
 
+namespace
+{
+    // Best-of-N drum search on plain values (safe on the generation worker). Candidate i uses
+    // key.toInt(i), so any pick can be regenerated from the key.
+    std::vector<BoomAudioProcessor::DrumCandidate> searchDrumCandidates(const boom::drums::DrumStyleSpec& spec,
+        int bars, int restPct, int dottedPct, int tripletPct, int swingPct, const boom::seed::Key& key,
+        const boom::groove::Grid* bassGrid, const boom::search::Targets& targets, int count, int topK)
+    {
+        using Pattern = BoomAudioProcessor::Pattern;
+        return boom::search::bestOf<Pattern>(count, topK,
+            [&](int i) { return key.toInt((std::uint64_t)i); },
+            [&](int seed, Pattern& out)
+            {
+                boom::drums::DrumPattern pat;
+                boom::drums::generate(spec, bars, restPct, dottedPct, tripletPct, swingPct, seed, pat);
+                copyDrumPattern(pat, out);
+            },
+            [&](const Pattern& p)
+            {
+                return boom::search::scoreGroove(boom::groove::makeGrid(p, bars), targets, bassGrid);
+            });
+    }
+}
+
+std::vector<BoomAudioProcessor::DrumCandidate> BoomAudioProcessor::generateDrumCandidates(int count, int topK, const boom::search::Targets& targets)
+{
+    auto styleId = boom::drums::StyleId::Trap;
+    if (auto* ch = dynamic_cast<juce::AudioParameterChoice*>(apvts.getParameter("style")))
+        styleId = boom::drums::styleFromIndex(ch->getIndex());
+
+    const int bars = getBars();
+
+    // Kicks are scored against the current bass line when there is one
+    const auto bassGrid = boom::groove::makeGrid(getMelodicPattern(), bars, 0);
+    const bool haveBass = !getMelodicPattern().isEmpty();
+
+    // One key for the whole batch
+    const auto key = nextSeedKey(boom::seed::Op::Generate);
+
+    return searchDrumCandidates(boom::drums::getSpec(styleId), bars, getPct(apvts, "restDensity", 0),
+        getPct(apvts, "dottedDensity", 0), getPct(apvts, "tripletDensity", 0), getPct(apvts, "swing", 0),
+        key, haveBass ? &bassGrid : nullptr, targets, count, topK);
+}
+
 void BoomAudioProcessor::aiSlapsmithExpand(int bars)
 {
     // Use current style name if you store it in APVTS choice "style". If not present, default to "trap".
@@ -517,250 +416,577 @@ void BoomAudioProcessor::aiSlapsmithExpand(int bars)
     const int dottedPct = getPct(apvts, "dottedDensity", 0);
     int       tripletPct = getPct(apvts, "tripletDensity", 0);
     const int swingPct = getPct(apvts, "swing", 0);
-    if (baseStyle.equalsIgnoreCase("drill")) tripletPct = clampInt(tripletPct + 10, 0, 100);
-
-    // Generate a fresh embellishment
-    auto styles = boom::drums::styleNames();
-    if (!styles.contains(baseStyle))
-        baseStyle = styles[0];
-
-    boom::drums::DrumStyleSpec spec = boom::drums::getSpec(baseStyle);
-    boom::drums::DrumPattern pat;
-    boom::drums::generate(spec, bars, restPct, dottedPct, tripletPct, swingPct, /*seed*/ -1, pat);
+    const auto styleId = boom::drums::styleFromName(baseStyle, boom::drums::StyleId::Trap);
+    if (styleId == boom::drums::StyleId::Drill) tripletPct = clampInt(tripletPct + 10, 0, 100);
+
+    // Generate a fresh embellishment (locked rows and bars are skipped, as for Generate)
+    const auto& spec = boom::drums::getSpec(styleId);
+    const auto& drumLocks = getLocks(boom::Engine::Drums);
+    boom::drums::DrumPattern extra;
+    boom::drums::generate(spec, bars, restPct, dottedPct, tripletPct, swingPct, nextSeed(boom::seed::Op::Slapsmith), extra,
+        drumLocks.any() ? &drumLocks : nullptr);
+
+    // Expand, don't replace: overlay the new hits as ghost notes in the gaps of the current drums.
+    // The backbone is never moved or removed; each row grows by a capped amount per bar.
+    boom::drums::MergeRules rules;
+    for (int r = 0; r < boom::drums::NumRows; ++r)
+        rules.maxHitsPerBar[r] = spec.rows[r].maxHitsPerBar;
+
+    if (getDrumPattern().isEmpty())
+    {
+        Pattern fresh; // nothing to expand yet: the embellishment is the pattern
+        copyDrumPattern(extra, fresh);
+        setDrumPattern(std::move(fresh));
+        return;
+    }
 
-    // Merge with existing by simply replacing (simplest/robust). If you want true "expand", merge selectively.
-    BoomAudioProcessor::Pattern out;
-    out.ensureStorageAllocated(pat.size());
-    for (const auto& e : pat)
+    // Every slot of a locked row or bar is blocked for the merge
+    boom::drums::LockMask lockMask;
+    if (drumLocks.any())
     {
-        BoomAudioProcessor::Note n;
-        n.row = e.row;
-        n.startTick = e.startTick;
-        n.lengthTicks = e.lenTicks;
-        n.velocity = juce::jlimit<int>(1, 127, (int)e.vel);
-        out.add(n);
+        lockMask.assign((size_t)juce::jmax(1, bars) * boom::drums::NumRows, 0);
+        for (int b = 0; b < juce::jmax(1, bars); ++b)
+            for (int r = 0; r < boom::drums::NumRows; ++r)
+                if (drumLocks.locked(r, b))
+                    lockMask[(size_t)b * boom::drums::NumRows + (size_t)r] = ~0ull;
     }
-    setDrumPattern(out);
+
+    auto pat = getDrumPattern(); // the one copy; merged in place and moved back
+    if (boom::drums::mergeEmbellishments(pat, extra, bars, rules, lockMask.empty() ? nullptr : &lockMask) > 0)
+        setDrumPattern(std::move(pat));
 }
 
 void BoomAudioProcessor::randomizeCurrentEngine(int bars)
 {
     // We’ll randomize slider/choice style and generate **drums**. (Bass/808 can be added after you confirm names)
-    std::random_device rd; std::mt19937 rng(rd());
+    // Parameter picks and the pattern come from separate sub-streams of one key (the editor's box
+    // picks use a third, salt 2, of the same key); the variation cache usually has this key's take ready.
+    Variation take;
+    if (!takeVariation(kVarDice, diceHash(bars), boom::seed::Op::Randomize, take))
+        buildDiceTake(nextSeedKey(boom::seed::Op::Randomize), diceStyleChoices(), dicePctParams(), bars, take);
 
     // Randomize style if you have a "style" parameter (AudioParameterChoice)
-    if (auto* prm = apvts.getParameter("style"))
-    {
-        auto* ch = static_cast<juce::AudioParameterChoice*>(prm);
-        if (ch->choices.size() > 0)
-        {
-            const int idx = std::uniform_int_distribution<int>(0, ch->choices.size() - 1)(rng);
-            ch->operator=(idx);
-        }
-    }
+    if (take.picks.styleIndex >= 0)
+        if (auto* prm = apvts.getParameter("style"))
+            static_cast<juce::AudioParameterChoice*>(prm)->operator=(take.picks.styleIndex);
 
     // Randomize density sliders if present
-    auto randPct = [&](const char* id, int lo, int hi)
+    auto setPct = [&](const char* id, int v)
     {
+        if (v < 0) return;
         if (auto* r = apvts.getRawParameterValue(id))
-        {
-            const int v = std::uniform_int_distribution<int>(lo, hi)(rng);
             r->operator=((float)v);
-        }
     };
-    randPct("restDensity", 0, 60);
-    randPct("dottedDensity", 0, 40);
-    randPct("tripletDensity", 0, 60);
-    randPct("swing", 0, 40);
+    setPct("restDensity", take.picks.restPct);
+    setPct("dottedDensity", take.picks.dottedPct);
+    setPct("tripletDensity", take.picks.tripletPct);
+    setPct("swing", take.picks.swingPct);
+
+    // Locked rows / bars keep the notes on screen (the cached take is built for the whole grid)
+    auto& pat = take.result.pattern;
+    const auto& lk = locks[(int)boom::Engine::Drums];
+    if (lk.any()) lk.splice(drumPattern, pat, getLockBarTicks(boom::Engine::Drums), true);
+
+    setDrumPattern(std::move(pat));
+    liveSeed[(int)boom::Engine::Drums] = take.result.seed;
+    refillVariations();
+}
 
-    // Generate drums for the randomized style
-    juce::String style = "trap";
+namespace
+{
+    // Parameters the Dice rolls, in draw order, with their ranges
+    struct DicePct { const char* id; int lo, hi; };
+    constexpr DicePct kDicePcts[] = { { "restDensity", 0, 60 }, { "dottedDensity", 0, 40 },
+                                      { "tripletDensity", 0, 60 }, { "swing", 0, 40 } };
+}
+
+juce::StringArray BoomAudioProcessor::diceStyleChoices() const
+{
     if (auto* prm = apvts.getParameter("style"))
-        style = static_cast<juce::AudioParameterChoice*>(prm)->getCurrentChoiceName();
+        return static_cast<juce::AudioParameterChoice*>(prm)->choices;
+    return {};
+}
 
-    auto styles = boom::drums::styleNames();
-    if (!styles.contains(style) && styles.size() > 0)
-        style = styles[0];
+std::uint8_t BoomAudioProcessor::dicePctParams() const
+{
+    std::uint8_t mask = 0;
+    for (size_t i = 0; i < std::size(kDicePcts); ++i)
+        if (apvts.getRawParameterValue(kDicePcts[i].id) != nullptr) mask |= (std::uint8_t)(1u << i);
+    return mask;
+}
 
-    const int restPct = getPct(apvts, "restDensity", 0);
-    const int dottedPct = getPct(apvts, "dottedDensity", 0);
-    const int tripletPct = getPct(apvts, "tripletDensity", 0);
-    const int swingPct = getPct(apvts, "swing", 0);
+// Pure: the Dice's parameter picks (only for parameters that exist, so the draws line up with
+// the live ones) and the drum pattern for the picked style and feel
+void BoomAudioProcessor::buildDiceTake(const boom::seed::Key& key, const juce::StringArray& styles, std::uint8_t pctParams,
+    int bars, Variation& out)
+{
+    auto rng = key.rng(1);
+    DicePicks& picks = out.picks;
+    picks = {};
 
+    juce::String style = "trap";
+    if (styles.size() > 0)
+    {
+        picks.styleIndex = rng.below(styles.size());
+        style = styles[picks.styleIndex];
+    }
+
+    int pct[std::size(kDicePcts)] {};
+    for (size_t i = 0; i < std::size(kDicePcts); ++i)
+        if ((pctParams >> i) & 1u) pct[i] = rng.range(kDicePcts[i].lo, kDicePcts[i].hi);
+    picks.restPct    = (pctParams & 1u) ? pct[0] : -1;
+    picks.dottedPct  = (pctParams & 2u) ? pct[1] : -1;
+    picks.tripletPct = (pctParams & 4u) ? pct[2] : -1;
+    picks.swingPct   = (pctParams & 8u) ? pct[3] : -1;
+
+    const auto styleId = boom::drums::styleFromName(style, boom::drums::StyleId::Trap);
 
-    boom::drums::DrumStyleSpec spec = boom::drums::getSpec(style);
     boom::drums::DrumPattern pat;
-    boom::drums::generate(spec, bars, restPct, dottedPct, tripletPct, swingPct, /*seed*/ -1, pat);
+    boom::drums::generate(boom::drums::getSpec(styleId), bars, pct[0], pct[1], pct[2], pct[3], key.toInt(), pat);
 
-    BoomAudioProcessor::Pattern out;
-    out.ensureStorageAllocated(pat.size());
+    Pattern& dst = out.result.pattern;
+    out.result.engine = boom::Engine::Drums;
+    out.result.seed = key.toInt();
+    dst.clearQuick();
+    dst.ensureStorageAllocated(pat.size());
     for (const auto& e : pat)
     {
-        BoomAudioProcessor::Note n;
+        Note n;
         n.row = e.row;
         n.startTick = e.startTick;
         n.lengthTicks = e.lenTicks;
         n.velocity = juce::jlimit<int>(1, 127, (int)e.vel);
-        out.add(n);
+        dst.add(n);
     }
-    setDrumPattern(out);
 }
 
-void BoomAudioProcessor::generateBassFromSpec(const juce::String& styleName,
-    int bars,
-    int octave,
-    int restPct,
-    int dottedPct,
-    int tripletPct,
-    int swingPct,
-    int seed)
+// ============================================================
+// Long form (Drums): sections over shared bar cells.
+// Each section kind is generated once (as long as its longest section) with its own feel and
+// seed; every section of that kind replays those cells. Bars that come out identical (phrase
+// copies without mutations) are stored once.
+// ============================================================
+namespace
 {
-    // ---- Safety / setup ----
-    const int barsClamped = juce::jlimit(1, 16, bars);
-    const int total16 = barsClamped * 16;
-    const int tpq = kTicksPerQuarter;
-    const int ticksPer16 = kTicksPer16;
+    // Rest-density offset per section kind: sparse intro/outro, busier hook
+    constexpr int kFormRestDelta[(int)boom::form::Kind::NumKinds] = { 30, 0, -10, 15, 20 };
+}
 
-    // Variety seed
-    juce::Random rng = (seed >= 0)
-        ? juce::Random((int)seed)
-        : juce::Random((int)(juce::Time::getMillisecondCounter() ^ (uintptr_t)this));
+void BoomAudioProcessor::generateDrumForm(boom::drums::StyleId style, int bars, int restPct, int dottedPct,
+    int tripletPct, int swingPct, int seed)
+{
+    boom::form::Form<Note> form;
+    buildDrumForm(boom::drums::getSpec(style), bars, restPct, dottedPct, tripletPct, swingPct,
+        (std::uint32_t)resolveSeed(seed, boom::seed::Op::Generate), form);
+
+    Pattern song;
+    form.expand(song);
+    setDrumPattern(std::move(song));
+    drumForm = std::move(form); // after setDrumPattern, which drops any previous form
+}
 
-    // Pull per-style spec (rhythm weights, biases)
-    auto spec = getBassStyleSpec(styleName.trim().toLowerCase());
+void BoomAudioProcessor::buildDrumForm(const boom::drums::DrumStyleSpec& spec, int bars, int restPct, int dottedPct,
+    int tripletPct, int swingPct, std::uint32_t songSeed, boom::form::Form<Note>& form,
+    const std::function<bool()>& cancelled)
+{
+    using boom::form::Kind;
+    bars = juce::jlimit(1, 128, bars);
 
-    // Convert UI percents to [0..1]
-    const float restF = juce::jlimit(0.f, 1.f, restPct / 100.f);
-    const float dottedF = juce::jlimit(0.f, 1.f, dottedPct / 100.f);
-    const float tripletF = juce::jlimit(0.f, 1.f, tripletPct / 100.f);
-    const float swingF = juce::jlimit(0.f, 1.f, swingPct / 100.f);
+    std::vector<boom::form::Section> sections;
+    boom::form::layout(bars, sections);
 
-    // Effective density: base scaled by (1 - rest)
-    const float density = juce::jlimit(0.f, 1.f, spec.baseDensity * (1.0f - restF));
+    int kindBars[(int)Kind::NumKinds] = {};
+    for (const auto& s : sections)
+        kindBars[(int)s.kind] = juce::jmax(kindBars[(int)s.kind], s.bars);
 
-    // Prepare pattern out (use your existing melodic note struct)
-    auto pat = getMelodicPattern();
-    pat.clearQuick();
+    form.clear();
+    form.barTicks = 4 * PPQ;
+    std::vector<int> kindCells[(int)Kind::NumKinds];
+    boom::drums::DrumPattern take;
 
-    // Choose a single nominal pitch line (you said rhythm-first; keep melody minimal)
-    // Root pitch from key/scale can be fetched if you have it; here we anchor by octave.
-    // Middle C=60; octave offset => 12 * (octave - 4)
-    const int basePitch = 36 + (octave * 12); // C2 as base for octave=0; tweak if needed
+    for (int k = 0; k < (int)Kind::NumKinds; ++k)
+    {
+        if (kindBars[k] == 0) continue;
+        if (cancelled && cancelled()) return;
 
-    // Build a per-16th probability table for the whole region with syncopation bias
-    juce::Array<float> prob16; prob16.resize(total16);
-    for (int i = 0; i < total16; ++i)
+        // The verse keeps the song seed, so a one-section form is exactly boom::drums::generate
+        const int kindSeed = (k == (int)Kind::Verse) ? (int)songSeed
+            : (int)(std::uint32_t)boom::splitmix64(((std::uint64_t)songSeed << 8) | (std::uint64_t)k);
+        boom::drums::generate(spec, kindBars[k], clampInt(restPct + kFormRestDelta[k], 0, 100),
+            dottedPct, tripletPct, swingPct, kindSeed, take);
+
+        std::vector<Pattern> barNotes((size_t)kindBars[k]);
+        for (const auto& e : take)
+        {
+            const int bar = e.startTick / form.barTicks;
+            if (bar < 0 || bar >= kindBars[k]) continue;
+            Note n;
+            n.row = e.row;
+            n.startTick = e.startTick - bar * form.barTicks;
+            n.lengthTicks = e.lenTicks;
+            n.velocity = juce::jlimit(1, 127, e.vel);
+            barNotes[(size_t)bar].add(n);
+        }
+        for (auto& b : barNotes)
+            kindCells[k].push_back(form.addCell(std::move(b)));
+    }
+
+    for (const auto& s : sections)
     {
-        const int p = i % 16;
-        float w = (float)spec.weight16[p];
+        const auto& cells = kindCells[(int)s.kind];
+        boom::form::Form<Note>::Placed placed { s, {} };
+        placed.cells.reserve((size_t)s.bars);
+        for (int b = 0; b < s.bars; ++b)
+            placed.cells.push_back(cells[(size_t)b % cells.size()]);
+        form.sections.push_back(std::move(placed));
+    }
+}
 
-        // bias off-beats if syncBias > 0, bias on-beats if < 0
-        const bool onBeat = (p % 4 == 0);
-        w += (onBeat ? -1.f : +1.f) * (std::abs(spec.syncBias) * 3.0f);
+BoomAudioProcessor::GenRequest BoomAudioProcessor::makeGenRequest(boom::Engine engine) const
+{
+    GenRequest r;
+    r.engine = engine;
+    r.bars = getBars();
+    r.restPct = getPct(apvts, "restDensity", getPct(apvts, engine == boom::Engine::Drums ? "restDensityDrums" : "restDensity808", 0));
+    r.dottedPct = getPct(apvts, "dottedDensity", 0);
+    r.tripletPct = getPct(apvts, "tripletDensity", 0);
+    r.locks = locks[(int)engine];
+
+    const auto* choice = dynamic_cast<juce::AudioParameterChoice*>(apvts.getParameter("style"));
+    if (engine == boom::Engine::Drums)
+    {
+        auto styleId = boom::drums::StyleId::Trap;
+        if (choice != nullptr)
+            styleId = boom::drums::styleFromIndex(choice->getIndex());
+        r.style = boom::drums::styleName(styleId);
+        r.swingPct = getPct(apvts, "swing", 0);
+    }
+    else
+    {
+        r.style = "trap";
+        if (choice != nullptr)
+        {
+            const auto styles = boom::styleChoices();
+            if (styles.size() > 0)
+                r.style = styles[juce::jlimit(0, styles.size() - 1, choice->getIndex())];
+        }
+        if (auto* oct = dynamic_cast<juce::AudioParameterInt*>(apvts.getParameter("octave")))
+            r.octave = oct->get();
+        r.swingPct = 0; // hook your swing slider/param here later
+    }
+    return r;
+}
 
-        // dotted/triplet influence: gently nudge certain slots
-        if (dottedF > 0.05f)
+// Everything the build needs is copied here (message thread); the returned job reads nothing else
+BoomAudioProcessor::GenBuild BoomAudioProcessor::makeGenBuild(const GenRequest& r, const boom::seed::Key& key)
+{
+    if (r.engine == boom::Engine::Drums)
+    {
+        const auto* spec = &boom::drums::getSpec(r.style); // immutable style table, safe to share
+        if (r.locks.any())
         {
-            // dotted 8th (3x 1/16) emphasis -> positions 3, 7, 11, 15
-            if (p == 3 || p == 7 || p == 11 || p == 15) w += 2.0f * dottedF;
+            // Locked rows / bars: one flat take of the unlocked area only (no form sections)
+            const int seed = r.seed >= 0 ? r.seed : key.toInt();
+            return [r, spec, seed](const std::function<bool()>&, GenResult& out)
+            {
+                boom::drums::DrumPattern take;
+                boom::drums::generate(*spec, r.bars, r.restPct, r.dottedPct, r.tripletPct, r.swingPct, seed, take, &r.locks);
+                out.engine = boom::Engine::Drums;
+                out.seed = seed;
+                out.locks = r.locks;
+                copyDrumPattern(take, out.pattern);
+                return true;
+            };
         }
-        if (tripletF > 0.05f)
+
+        if (r.candidates > 1)
         {
-            // crude triplet feel bump near 1/3 and 2/3 of a beat: positions 1,5,9,13 and 3,7,11,15
-            if (p == 1 || p == 5 || p == 9 || p == 13) w += 1.6f * tripletF;
-            if (p == 3 || p == 7 || p == 11 || p == 15) w += 1.2f * tripletF;
+            const bool haveBass = !getMelodicPattern().isEmpty();
+            const auto bassGrid = boom::groove::makeGrid(getMelodicPattern(), r.bars, 0);
+            return [r, spec, key, haveBass, bassGrid](const std::function<bool()>&, GenResult& out)
+            {
+                auto best = searchDrumCandidates(*spec, r.bars, r.restPct, r.dottedPct, r.tripletPct, r.swingPct,
+                    key, haveBass ? &bassGrid : nullptr, {}, r.candidates, 1);
+                if (best.empty()) return false;
+                out.engine = boom::Engine::Drums;
+                out.pattern = std::move(best.front().pattern);
+                out.seed = best.front().seed;
+                return true;
+            };
         }
 
-        prob16.set(i, juce::jmax(0.0f, w));
+        const auto songSeed = (std::uint32_t)(r.seed >= 0 ? r.seed : key.toInt());
+        return [r, spec, songSeed](const std::function<bool()>& cancelled, GenResult& out)
+        {
+            out.engine = boom::Engine::Drums;
+            out.seed = (int)songSeed;
+            buildDrumForm(*spec, r.bars, r.restPct, r.dottedPct, r.tripletPct, r.swingPct, songSeed, out.form, cancelled);
+            if (cancelled()) return false;
+            out.form.expand(out.pattern);
+            return true;
+        };
     }
 
-    // Normalize-ish and then sample per 16th based on density
-    // Target hits ~ density * total16 * 0.6 (tunable)
-    const int targetHits = juce::jmax(1, (int)std::round(density * total16 * 0.6f));
-
-    // Build a weighted index bag
-    juce::Array<int> idx; idx.ensureStorageAllocated(total16);
-    float sumW = 0.f;
-    for (int i = 0; i < total16; ++i) sumW += prob16[i];
-    if (sumW <= 0.001f) sumW = 1.0f;
+    // Bass: the kick bias is copied, the worker never sees the drum pattern
+    const auto* spec = &boom::bass::getStyle(r.style.trim());
+    const int seed = r.seed >= 0 ? r.seed : key.toInt();
+    const int tsNum = getTimeSigNumerator(), tsDen = getTimeSigDenominator();
+    const float coupling = getKickCoupling();
+    std::vector<float> kick = getKickBias(r.bars);
+    return [r, spec, seed, tsNum, tsDen, coupling, kick = std::move(kick)](const std::function<bool()>&, GenResult& out)
+    {
+        out.engine = r.engine;
+        out.seed = seed;
+        out.locks = r.locks;
+        out.barTicks = tsNum * (4 * PPQ / juce::jmax(1, tsDen)); // = getLockBarTicks(engine)
+        buildBassPattern(*spec, r.bars, tsNum, tsDen, r.octave, r.restPct, r.dottedPct, r.tripletPct, r.swingPct,
+            seed, &kick, coupling, out.pattern, r.locks.any() ? &r.locks : nullptr);
+        return true;
+    };
+}
 
-    // Greedy sampling without replacement
-    juce::Array<bool> taken; taken.resize(total16); for (int i = 0; i < total16; ++i) taken.set(i, false);
+// Snapshot on the message thread, build on the worker, apply back on the message thread.
+// A plain draw (next seed key, one take) is first looked up in the variation cache.
+std::uint64_t BoomAudioProcessor::requestGeneration(GenRequest r)
+{
+    r.bars = juce::jlimit(1, 128, r.bars);
+    if (r.locks.any())
+    {
+        if (r.locks.allLocked(r.engine == boom::Engine::Drums ? boom::drums::NumRows : 0, r.bars))
+            return 0; // nothing left to generate
+        r.candidates = 0; // a search would score whole patterns, not the unlocked part
+    }
 
-    auto drawIndex = [&]()
+    if (r.seed < 0 && r.candidates <= 1)
     {
-        float r = urand01(rng) * sumW;
-        for (int i = 0; i < total16; ++i)
+        Variation take;
+        const int slot = r.engine == boom::Engine::Drums ? kVarDrums : kVarBass;
+        if (takeVariation(slot, variationHash(r), boom::seed::Op::Generate, take))
         {
-            if (taken[i]) continue;
-            r -= prob16[i];
-            if (r <= 0.0f)
-                return i;
+            generator.cancel(); // an older Generate still running must not land on top of this one (only Generates run here)
+            applyGenerated(std::move(take.result));
+            refillVariations();
+            return 0;
         }
-        // fallback linear search for first available
-        for (int i = 0; i < total16; ++i)
-            if (!taken[i]) return i;
-        return 0;
-    };
+    }
 
-    for (int k = 0; k < targetHits; ++k)
+    // Candidate searches always draw a key; a pinned seed on a single take needs none
+    boom::seed::Key key;
+    if (r.seed < 0 || r.candidates > 1)
+        key = nextSeedKey(boom::seed::Op::Generate);
+
+    auto build = makeGenBuild(r, key);
+    return generator.submit([build = std::move(build)](const auto& cancelled, GenResult& out)
+    {
+        return build([&cancelled] { return cancelled(); }, out);
+    });
+}
+
+void BoomAudioProcessor::applyGenerated(GenResult&& r)
+{
+    // Locked regions keep what is on screen now, including edits made while the take was built
+    if (r.locks.any())
+        r.locks.splice(r.engine == boom::Engine::Drums ? drumPattern : melodicPattern, r.pattern, r.barTicks,
+            r.engine == boom::Engine::Drums);
+
+    if (r.engine == boom::Engine::Drums)
+    {
+        setDrumPattern(std::move(r.pattern));
+        drumForm = std::move(r.form); // empty for candidate picks
+    }
+    else
     {
-        const int i = drawIndex();
-        taken.set(i, true);
-        sumW -= prob16[i];
-        idx.add(i);
+        setMelodicPattern(r.pattern);
     }
+    liveSeed[(int)r.engine] = r.seed; // after the set, which forgets the previous take's seed
 
-    // Convert chosen 16th slots -> note events. Length rules:
-    // - default: 1/8 long (2 * 1/16)
-    // - occasionally tie two 1/16s (dotted feel)
-    // - occasionally split into 1/32 pair
-    for (int i : idx)
+    notifyPatternChanged();
+    if (onGenerated) onGenerated(r.engine);
+}
+
+bool BoomAudioProcessor::isLiveRegenerate() const noexcept
+{
+    if (auto* v = apvts.getRawParameterValue("liveRegen"))
+        return v->load() > 0.5f;
+    return false;
+}
+
+// Same seed, current sliders: a pinned-seed request skips the variation cache and the seed counter
+std::uint64_t BoomAudioProcessor::regenerateLive(boom::Engine engine)
+{
+    if (engine != boom::Engine::Drums && engine != boom::Engine::Bass) return 0;
+    const int seed = liveSeed[(int)engine];
+    if (seed < 0) return 0;
+
+    auto req = makeGenRequest(engine);
+    req.seed = seed;
+    return requestGeneration(req);
+}
+
+// ============================================================
+// Variation cache: takes for the next Generate / Dice keys, built by the prefetch worker.
+// Only the current engine's Generate ring and the Dice ring are refilled; a take is built for a
+// key peeked from the seed counter, so it matches only if nothing else drew a key in between.
+// ============================================================
+namespace
+{
+    inline std::uint64_t hashMix(std::uint64_t h, std::uint64_t v) noexcept { return boom::splitmix64(h ^ v); }
+}
+
+void BoomAudioProcessor::setVariationPrefetch(bool enabled)
+{
+    if (prefetchEnabled == enabled) return;
+    prefetchEnabled = enabled;
+
+    if (enabled)
     {
-        const int startTick = i * ticksPer16;
-        int lenTicks = 2 * ticksPer16; // 1/8 default
+        startTimerHz(10);
+        refillVariations();
+        return;
+    }
 
-        // dotted bias (extend by 1/16) based on dottedF
-        if (urand01(rng) < (0.25f * dottedF))
-            lenTicks += ticksPer16;
+    stopTimer();
+    prefetcher.cancel();
+    for (auto& ring : variations) ring.reset(0);
+}
 
-        // occasional split into two 1/32 hits
-        const bool split32 = (urand01(rng) < spec.splitTo32Prob * (0.5f + 0.5f * (1.0f - restF)));
-        if (!split32)
-        {
-            // single note
-            pat.add({ basePitch, startTick, lenTicks, 100, 1 });
-        }
-        else
-        {
-            const int hit32 = ticksPer16 / 2; // 1/32 ticks
-            pat.add({ basePitch, startTick, hit32, 100, 1 });
-            const int start2 = startTick + hit32 + (rng.nextBool() ? 0 : hit32); // sometimes a little gap
-            pat.add({ basePitch, start2, hit32, 96, 1 });
-        }
+std::uint64_t BoomAudioProcessor::variationHash(const GenRequest& r) const
+{
+    std::uint64_t h = hashMix(0x6A09E667F3BCC908ull, (std::uint64_t)(int)r.engine);
+    h = hashMix(h, (std::uint64_t)r.style.hashCode64());
+    for (int v : { r.bars, r.octave, r.restPct, r.dottedPct, r.tripletPct, r.swingPct, r.seed, r.candidates })
+        h = hashMix(h, (std::uint64_t)(std::uint32_t)v);
+    h = hashMix(h, r.locks.hash());
+
+    if (r.engine != boom::Engine::Drums)
+    {
+        // Bass follows the meter and, through the kick bias, the drums
+        h = hashMix(h, (std::uint64_t)(getTimeSigNumerator() * 64 + getTimeSigDenominator()));
+        h = hashMix(h, (std::uint64_t)juce::roundToInt(getKickCoupling() * 1000.0f));
+        h = hashMix(h, (std::uint64_t)drumPatternVersion);
     }
+    return h;
+}
 
-    // Apply swing (timing offset on even 1/8s). Simple micro-timing at tick level.
-    if (swingF > 0.01f)
+std::uint64_t BoomAudioProcessor::diceHash(int bars) const
+{
+    // The Dice overwrites the feel parameters, so only what shapes its draws counts
+    std::uint64_t h = hashMix(0xBB67AE8584CAA73Bull, (std::uint64_t)bars);
+    h = hashMix(h, (std::uint64_t)diceStyleChoices().joinIntoString("|").hashCode64());
+    return hashMix(h, (std::uint64_t)dicePctParams());
+}
+
+bool BoomAudioProcessor::takeVariation(int slot, std::uint64_t hash, boom::seed::Op op, Variation& out)
+{
+    auto& ring = variations[(size_t)slot];
+    if (!prefetchEnabled || ring.hash() != hash) return false;
+    if (!ring.take(peekSeedKey(op), out)) return false;
+
+    nextSeedKey(op); // draw the key the take was built for, as a fresh generate would have
+    return true;
+}
+
+void BoomAudioProcessor::refillVariations()
+{
+    if (!prefetchEnabled || hasReplayKey) return;
+
+    struct Want { int slot; std::uint64_t hash; boom::seed::Op op; };
+    Want wants[2];
+    int numWants = 0;
+
+    GenRequest req;
+    const auto engine = getEngineSafe();
+    if (engine == boom::Engine::Drums || engine == boom::Engine::Bass) // 808 generates synchronously
+    {
+        req = makeGenRequest(engine);
+        wants[numWants++] = { engine == boom::Engine::Drums ? kVarDrums : kVarBass, variationHash(req), boom::seed::Op::Generate };
+    }
+    const int diceBars = getBars();
+    wants[numWants++] = { kVarDice, diceHash(diceBars), boom::seed::Op::Randomize };
+
+    // Drop takes built for other parameters or for keys that have been drawn since
+    bool stale = false;
+    for (int i = 0; i < numWants; ++i)
+    {
+        auto& ring = variations[(size_t)wants[i].slot];
+        if (ring.hash() != wants[i].hash) { ring.reset(wants[i].hash); stale = true; }
+        ring.dropUntil(peekSeedKey(wants[i].op));
+    }
+    if (stale) prefetcher.cancel();
+    if (prefetcher.isBusy()) return; // one take at a time; its result calls back in here
+
+    for (int i = 0; i < numWants; ++i)
     {
-        const int swingTicksMax = (int)std::round(0.5 * kTicksPer16 * swingF); // up to 50% of a 16th
-        for (int n = 0; n < pat.size(); ++n)
+        const Want w = wants[i];
+        auto& ring = variations[(size_t)w.slot];
+        if (ring.full()) continue;
+
+        const auto key = ring.empty() ? peekSeedKey(w.op) : ring.nextKey();
+        if (w.slot == kVarDice)
         {
-            auto note = pat[n];
-            const int sixteenth = note.startTick / kTicksPer16;
-            const bool isEven8th = ((sixteenth / 2) % 2) == 1; // 0,1 -> 8th#1, 2,3 -> 8th#2, etc.
-            if (isEven8th)
+            const auto styles = diceStyleChoices();
+            const auto pctParams = dicePctParams();
+            prefetcher.submit([w, key, styles, pctParams, diceBars](const auto&, Prefetched& out)
             {
-                note.startTick = juce::jmax(0, note.startTick + swingTicksMax);
-                pat.set(n, note);
-            }
+                out.slot = w.slot;
+                out.hash = w.hash;
+                out.key = key;
+                buildDiceTake(key, styles, pctParams, diceBars, out.take);
+                return true;
+            });
         }
+        else
+        {
+            auto build = makeGenBuild(req, key);
+            prefetcher.submit([w, key, build = std::move(build)](const auto& cancelled, Prefetched& out)
+            {
+                out.slot = w.slot;
+                out.hash = w.hash;
+                out.key = key;
+                return build([&cancelled] { return cancelled(); }, out.take.result);
+            });
+        }
+        return;
     }
+}
 
-    // Commit to processor state
+// ============================================================
+// Bass Generator – rhythm-first, style-weighted, variety-safe.
+// Everything rhythmic (subdivision weights, rest range, swing, hit cap, variation cadence, meter
+// hints) comes from boom::bass::StyleSpec in BassStyleDB; see boom::bass::generate.
+// ============================================================
+void BoomAudioProcessor::generateBassFromSpec(const juce::String& styleName,
+    int bars,
+    int octave,
+    int restPct,
+    int dottedPct,
+    int tripletPct,
+    int swingPct,
+    int seed)
+{
+    bars = juce::jlimit(1, 128, bars);
+    Pattern pat;
+    buildBassPattern(boom::bass::getStyle(styleName.trim()), bars, getTimeSigNumerator(), getTimeSigDenominator(), octave,
+        restPct, dottedPct, tripletPct, swingPct, resolveSeed(seed, boom::seed::Op::Generate),
+        &getKickBias(bars), getKickCoupling(), pat);
     setMelodicPattern(pat);
-    // If you have a change-broadcast mechanism, ping it here so the editor refreshes.
-    // sendChangeMessage(); // only if you already use it.
+}
+
+void BoomAudioProcessor::buildBassPattern(const boom::bass::StyleSpec& spec, int bars, int tsNum, int tsDen, int octave,
+    int restPct, int dottedPct, int tripletPct, int swingPct, int seed,
+    const std::vector<float>* kickBias, float coupling, Pattern& out, const boom::PatternLocks* locks)
+{
+    // Rhythm-first: one nominal pitch line anchored by octave (C2 for octave 0)
+    const int basePitch = juce::jlimit(0, 127, 36 + (octave * 12));
+
+    boom::bass::BassPattern hits;
+    boom::bass::generate(spec, bars, tsNum, tsDen, restPct, dottedPct, tripletPct, swingPct, seed, hits,
+        kickBias, coupling, locks);
+
+    out.clearQuick();
+    out.ensureStorageAllocated(hits.size());
+    for (const auto& h : hits)
+        out.add({ basePitch, 0, h.startTick, h.lenTicks, h.vel, 1 });
 }
 
 
@@ -769,19 +995,80 @@ BoomAudioProcessor::BoomAudioProcessor()
     : juce::AudioProcessor(BusesProperties().withOutput("Output", juce::AudioChannelSet::stereo(), true)),
     apvts(*this, nullptr, "PARAMS", createLayout())
 {
+    // The only non-deterministic draw: a fresh session gets its own seed (saved with the state)
+    randomSessionSeed = (std::uint32_t)juce::Random::getSystemRandom().nextInt64();
+
+    generator.onResult = [this](GenResult&& r) { applyGenerated(std::move(r)); };
+    transcriber.onResult = [this](Transcription&& t) { applyTranscription(std::move(t)); };
+    prefetcher.onResult = [this](Prefetched&& p)
+    {
+        auto& ring = variations[(size_t)p.slot];
+        if (ring.hash() == p.hash && (ring.empty() ? p.key == peekSeedKey(p.key.op) : p.key == ring.nextKey()))
+            ring.push(p.key, std::move(p.take));
+        refillVariations();
+    };
 }
 
 
 void BoomAudioProcessor::getStateInformation(juce::MemoryBlock& dest)
 {
+    auto state = apvts.copyState();
+    state.setProperty("sessionSeed", juce::String::toHexString((int)randomSessionSeed), nullptr);
+    state.setProperty("seedCounter", (int)seedCounter, nullptr);
+    state.setProperty("lastSeedKey", lastSeedKey.toString(), nullptr);
+
     juce::MemoryOutputStream mos(dest, true);
-    apvts.copyState().writeToStream(mos);
+    state.writeToStream(mos);
 }
 
 void BoomAudioProcessor::setStateInformation(const void* data, int sizeInBytes)
 {
     if (auto vt = juce::ValueTree::readFromData(data, (size_t)sizeInBytes); vt.isValid())
+    {
+        if (vt.hasProperty("sessionSeed"))
+            randomSessionSeed = (std::uint32_t)vt["sessionSeed"].toString().getHexValue32();
+        if (vt.hasProperty("seedCounter"))
+            seedCounter = (std::uint32_t)(int)vt["seedCounter"];
+        if (vt.hasProperty("lastSeedKey"))
+            lastSeedKey = boom::seed::Key::fromString(vt["lastSeedKey"].toString());
+
         apvts.replaceState(vt);
+    }
+}
+
+std::uint32_t BoomAudioProcessor::getSessionSeed() const noexcept
+{
+    // A non-zero "seed" param pins the session; 0 means "use this session's own random seed"
+    if (auto* v = apvts.getRawParameterValue("seed"))
+        if (const int s = (int)std::lround(v->load()); s != 0)
+            return (std::uint32_t)s;
+    return randomSessionSeed;
+}
+
+boom::seed::Key BoomAudioProcessor::peekSeedKey(boom::seed::Op op) const
+{
+    if (hasReplayKey) return replayKey;
+
+    boom::seed::Key k;
+    k.session = getSessionSeed();
+    k.engine = (std::uint8_t)getEngineSafe();
+    k.op = op;
+    k.counter = seedCounter & 0xFFFFFFu;
+    return k;
+}
+
+boom::seed::Key BoomAudioProcessor::nextSeedKey(boom::seed::Op op)
+{
+    if (hasReplayKey)
+    {
+        hasReplayKey = false;
+        lastSeedKey = replayKey;
+        return lastSeedKey;
+    }
+
+    lastSeedKey = peekSeedKey(op);
+    ++seedCounter;
+    return lastSeedKey;
 }
 
 
@@ -810,76 +1097,6 @@ void BoomAudioProcessor::bumpDrumRowsUp()
     notifyPatternChanged();
 }
 
-namespace
-{
-    // ---- Scale tables (semitones from root). Add more as you wish. ----
-    // These cover common choices and won’t block your build if a rare name is passed.
-    static const std::map<juce::String, std::vector<int>, std::less<>> kScales = {
-    {"Major",         {0, 2, 4, 5, 7, 9, 11}},
-    {"Natural Minor", {0, 2, 3, 5, 7, 8, 10}},
-    {"Harmonic Minor",{0, 2, 3, 5, 7, 8, 11}},
-    {"Dorian",        {0, 2, 3, 5, 7, 9, 10}},
-    {"Phrygian",      {0, 1, 3, 5, 7, 8, 10}},
-    {"Lydian",        {0, 2, 4, 6, 7, 9, 11}},
-    {"Mixolydian",    {0, 2, 4, 5, 7, 9, 10}},
-    {"Aeolian",       {0, 2, 3, 5, 7, 8, 10}},
-    {"Locrian",       {0, 1, 3, 5, 6, 8, 10}},
-    {"Locrian Nat6",    {0, 1, 3, 5, 6, 9, 10}},
-    {"Ionian #5",     {0, 2, 4, 6, 7, 9, 11}},
-    {"Dorian #4",     {0, 2, 3, 6, 7, 9, 10}},
-    {"Phrygian Dom",  {0, 1, 3, 5, 7, 9, 10}},
-    {"Lydian #2",     {0, 3, 4, 6, 7, 9, 11}},
-    {"Super Locrian", {0, 1, 3, 4, 6, 8, 10}},
-    {"Dorian b2",     {0, 1, 3, 5, 7, 9, 10}},
-    {"Lydian Aug",    {0, 2, 4, 6, 8, 9, 11}},
-    {"Lydian Dom",    {0, 2, 4, 6, 7, 9, 10}},
-    {"Mixo b6",       {0, 2, 4, 5, 7, 8, 10}},
-    {"Locrian #2",    {0, 2, 3, 5, 6, 8, 10}},
-    {"8 Tone Spanish", {0, 1, 3, 4, 5, 6, 8, 10}},
-    {"Phyrgian Nat3",    {0, 1, 4, 5, 7, 8, 10}},
-    {"Blues",         {0, 3, 5, 6, 7, 10}},
-    {"Hungarian Min", {0, 3, 5, 8, 11}},
-    {"Harmonic Maj(Ethopian)",  {0, 2, 4, 5, 7, 8, 11}},
-    {"Dorian b5",     {0, 2, 3, 5, 6, 9, 10}},
-    {"Phrygian b4",   {0, 1, 3, 4, 7, 8, 10}},
-    {"Lydian b3",     {0, 2, 3, 6, 7, 9, 11}},
-    {"Mixolydian b2", {0, 1, 4, 5, 7, 9, 10}},
-    {"Lydian Aug2",   {0, 3, 4, 6, 8, 9, 11}},
-    {"Locrian bb7",   {0, 1, 3, 5, 6, 8, 9}},
-    {"Pentatonic Maj", {0, 2, 5, 7, 8}},
-    {"Pentatonic Min", {0, 3, 5, 7, 10}},
-    {"Neopolitan Maj", {0, 1, 3, 5, 7, 9, 11}},
-    {"Neopolitan Min", {0, 1, 3, 5, 7, 8, 10}},
-    {"Spanish Gypsy",  {0, 1, 4, 5, 7, 8, 10}},
-    {"Romanian Minor", {0, 2, 3, 6, 7, 9, 10}},
-    {"Chromatic",      {0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11}},
-    {"Bebop Major",  {0, 2, 4, 5, 7, 8, 9, 11}},
-    {"Bebop Minor", {0, 2, 3, 5, 7, 8, 9, 10}}, };
-
-
-    inline int wrap12(int v) { v %= 12; if (v < 0) v += 12; return v; }
-
-    // Snap a MIDI pitch to the nearest pitch in (root + scale). Tie breaks upward.
-    inline int snapToScale(int midiPitch, int rootPC, const std::vector<int>& scalePCs)
-    {
-        const int pc = wrap12(midiPitch);
-        // Already in scale? keep it
-        for (int s : scalePCs) if (wrap12(rootPC + s) == pc) return midiPitch;
-
-        // Otherwise search nearest distance in semitones up/down (0..6)
-        for (int d = 1; d <= 6; ++d)
-        {
-            // up
-            if (std::find(scalePCs.begin(), scalePCs.end(), wrap12(pc - rootPC + d)) != scalePCs.end())
-                return midiPitch + d;
-            // down
-            if (std::find(scalePCs.begin(), scalePCs.end(), wrap12(pc - rootPC - d)) != scalePCs.end())
-                return midiPitch - d;
-        }
-        return midiPitch; // fallback (shouldn’t happen with Chromatic present)
-    }
-}
-
 void BoomAudioProcessor::transposeMelodic(int semitones, const juce::String& /*newKey*/,
     const juce::String& /*newScale*/, int octaveOffset)
 {
@@ -903,11 +1120,8 @@ void BoomAudioProcessor::bumppitTranspose(int targetKeyIndex, const juce::String
     targetKeyIndex = juce::jlimit(0, 11, targetKeyIndex);
     octaveDelta = juce::jlimit(-4, 4, octaveDelta);
 
-    // Find scale intervals; default to Chromatic if unknown
-    const std::vector<int>* scale = nullptr;
-    auto it = kScales.find(scaleName.trim());
-    if (it != kScales.end()) scale = &it->second;
-    if (scale == nullptr)   scale = &kScales.at("Chromatic");
+    // Scale id; default to Chromatic if unknown
+    const int scaleId = boom::scale::fromName(scaleName);
 
     // Transpose every melodic note to (root + scale), keep rhythm/length/velocity.
     // We’ll do: (a) octave shift, (b) snap to target scale relative to chosen key.
@@ -919,7 +1133,7 @@ void BoomAudioProcessor::bumppitTranspose(int targetKeyIndex, const juce::String
         int pitch = n.pitch + (octaveDelta * 12);
 
         // 2) snap to scale rooted at targetKeyIndex
-        pitch = snapToScale(pitch, targetKeyIndex, *scale);
+        pitch = boom::scale::snap(pitch, targetKeyIndex, scaleId);
 
         // Keep safe MIDI range
         n.pitch = juce::jlimit(0, 127, pitch);
@@ -953,14 +1167,10 @@ void BoomAudioProcessor::generate808(int bars,
 {
     juce::ignoreUnused(swingPct); // (hook swing later if needed)
 
-    // ----- Prep RNG -----
-    const uint32_t rngSeed = (seed == -1)
-        ? static_cast<uint32_t>(juce::Time::getMillisecondCounter())
-        : static_cast<uint32_t>(seed);
-    std::mt19937 rng(rngSeed);
-    auto rand01 = [&]() -> float {
-        return std::uniform_real_distribution<float>(0.0f, 1.0f)(rng);
-    };
+    // ----- Prep RNG (-1 = next seed key) -----
+    const uint32_t rngSeed = static_cast<uint32_t>(resolveSeed(seed, boom::seed::Op::Generate));
+    boom::Rng rng(rngSeed);
+    auto rand01 = [&]() -> float { return rng.nextFloat(); };
     auto chance = [&](float p01) { return rand01() < juce::jlimit(0.0f, 1.0f, p01); };
 
     // ----- Timing constants (96 PPQ) -----
@@ -972,51 +1182,19 @@ void BoomAudioProcessor::generate808(int bars,
     const int totalT = bars * barT;
 
     // ----- Scale helper (root + degree picker) -----
-    // We’ll map keyIndex (0=C .. 11=B) to MIDI, and derive a scale set by name.
-    // Your project already has all scale names; here we just build degrees quickly.
-    static const int semis[12] = { 0,1,2,3,4,5,6,7,8,9,10,11 }; // 0=C
+    // keyIndex (0=C .. 11=B) -> MIDI root; degrees come from the shared scale table (major if unknown)
     const int rootMidi = 12 * (juce::jlimit(-1, 9, octave) + 5) + juce::jlimit(0, 11, keyIndex); // center-ish
-
-    auto makeScaleSemis = [&](const juce::String& nm) -> std::vector<int>
-    {
-        auto n = nm.trim().toLowerCase();
-        // Basic sets (quick but effective); you already expose many modes in the UI
-        if (n.contains("minor") || n == "aeolian")
-            return { 0,2,3,5,7,8,10 };
-        if (n == "dorian")
-            return { 0,2,3,5,7,9,10 };
-        if (n == "phrygian")
-            return { 0,1,3,5,7,8,10 };
-        if (n == "lydian")
-            return { 0,2,4,6,7,9,11 };
-        if (n == "mixolydian")
-            return { 0,2,4,5,7,9,10 };
-        if (n == "locrian")
-            return { 0,1,3,5,6,8,10 };
-        if (n.contains("blues"))
-            return { 0,3,5,6,7,10 };
-        // default major/ionian
-        return { 0,2,4,5,7,9,11 };
-    };
-
-    const auto scaleDegrees = makeScaleSemis(scaleName);
+    const int scaleId = boom::scale::fromName(scaleName, boom::scale::kMajor);
+    const int scaleSize = boom::scale::size(scaleId);
 
     auto degreeMidi = [&](int degree) -> int
     {
-        const int d = juce::jlimit(0, (int)scaleDegrees.size() - 1, degree);
-        const int sm = scaleDegrees[d];
-        return rootMidi + sm;
+        return rootMidi + boom::scale::interval(scaleId, juce::jlimit(0, scaleSize - 1, degree));
     };
 
     auto nearestScaleBelow = [&](int midi) -> int
     {
-        // Walk down by semitone until we hit a scale tone modulo 12
-        for (int m = midi; m >= midi - 24; --m)
-        {
-            int mod = (m - rootMidi) % 12; if (mod < 0) mod += 12;
-            for (int sd : scaleDegrees) if (sd == mod) return m;
-        }
-        return midi;
+        return boom::scale::snapDown(midi, rootMidi, scaleId);
     };
 
     // ----- PATH 1: rhythmic family selection -----
@@ -1068,8 +1246,9 @@ void BoomAudioProcessor::generate808(int bars,
         start = juce::jlimit(0, totalT - 1, start);
         len = juce::jlimit(e16 / 2, barT, len);
 
-        // Works for juce::Array of your note struct (pitch,startTick,lengthTicks,velocity,channel)
+        // Works for juce::Array of your note struct (pitch,row,startTick,lengthTicks,velocity,channel)
         melodic.add({ juce::jlimit(0, 127, midi),
+                      0,     // row (unused for melodic notes)
                       start,
                       len,
                       juce::jlimit(1, 127, vel),
@@ -1086,14 +1265,18 @@ void BoomAudioProcessor::generate808(int bars,
         // every switch picks from {root, 5th, other} with bias
         float r = rand01();
         if (r < 0.55f) { targetDegree = 0; }                    // root
-        else if (r < 0.80f) { targetDegree = 4 % (int)scaleDegrees.size(); } // 5th
+        else if (r < 0.80f) { targetDegree = 4 % scaleSize; } // 5th
         else { // another scale tone
-            int k = (int)(rand01() * scaleDegrees.size());
-            targetDegree = juce::jlimit(0, (int)scaleDegrees.size() - 1, k);
+            int k = (int)(rand01() * scaleSize);
+            targetDegree = juce::jlimit(0, scaleSize - 1, k);
         }
         targetMidi = degreeMidi(targetDegree);
     };
 
+    // Cross-engine coupling with the current drum kicks (cached mask, see getKickBias)
+    const float coupling = getKickCoupling();
+    const auto& kicks = getKickBias(bars);
+
     // Walk schedule if chordWalk
     const int switchSpan = chance(0.5f) ? (barT / 2) : (barT); // 1/2 bar or 1 bar
     int nextSwitchAt = switchSpan;
@@ -1107,8 +1290,11 @@ void BoomAudioProcessor::generate808(int bars,
             nextSwitchAt += switchSpan;
         }
 
-        // rest gating
-        if (chance(restP)) continue;
+        // rest gating (kick coupling: fewer rests on kicks and more between them, or the reverse)
+        float restHere = restP;
+        if (coupling != 0.0f)
+            restHere = juce::jlimit(0.0f, 1.0f, restP + coupling * (0.5f - kicks[(size_t)juce::jlimit(0, (int)kicks.size() - 1, t / e16)]));
+        if (chance(restHere)) continue;
 
         // Base pitch:
         int baseMidi = rootCentric ? degreeMidi(0) : targetMidi;
@@ -1124,7 +1310,7 @@ void BoomAudioProcessor::generate808(int bars,
             else
             {
                 // some other degree
-                int d = (int)(rand01() * scaleDegrees.size());
+                int d = (int)(rand01() * scaleSize);
                 baseMidi = degreeMidi(d);
             }
         }
@@ -1166,6 +1352,10 @@ void BoomAudioProcessor::generate808(int bars,
         }
     }
 
+    // Locked bars keep the notes on screen
+    const auto& lk = locks[(int)boom::Engine::e808];
+    if (lk.any()) lk.splice(melodicPattern, melodic, getLockBarTicks(boom::Engine::e808), false);
+
     // Commit to processor + notify UI
     setMelodicPattern(melodic);
 }
@@ -1173,6 +1363,7 @@ void BoomAudioProcessor::generate808(int bars,
 void BoomAudioProcessor::generateBass(int bars)
 {
     // For now, use same generator as 808 (different velocity range and fewer long holds)
+    prng.setSeed(nextSeedKey(boom::seed::Op::Generate).derive());
     auto pat = getMelodicPattern();
     pat.clear();
 
@@ -1196,7 +1387,7 @@ void BoomAudioProcessor::generateBass(int bars)
                 pitch += steps[irand(0, (int)std::size(steps) - 1)];
             }
 
-            pat.add({ pitch, toTick16(i), toTick16(juce::jmax(1, len16)), vel, 1 });
+            pat.add({ pitch, 0, toTick16(i), toTick16(juce::jmax(1, len16)), vel, 1 });
             i += (len16 - 1);
         }
     }
@@ -1205,36 +1396,44 @@ void BoomAudioProcessor::generateBass(int bars)
     notifyPatternChanged();
 }
 
-// Build a probability mask from the current kick pattern (row 0) at 16th-note resolution.
-// Returns a vector<int> length = bars*16, values in [0..100] = probability boost.
-static std::vector<int> buildKickBiasMask(const BoomAudioProcessor& proc, int bars)
+// Kick bias at 16th resolution: a kick adds a velocity-scaled boost over its length, its neighbours
+// get a small one (so lines "tend" toward kicks without being locked), and empty slots keep a baseline.
+const std::vector<float>& BoomAudioProcessor::getKickBias(int bars)
 {
-    const int total16 = proc.q16(bars);
-    std::vector<int> bias(total16, 0);
+    const size_t total16 = (size_t)q16(juce::jmax(1, bars));
+    if (kickBiasVersion == drumPatternVersion && kickBias.size() == total16)
+        return kickBias;
 
-    const auto drums = proc.getDrumPattern();
-    for (const auto& n : drums)
+    kickBias.assign(total16, 0.0f);
+    for (const auto& n : drumPattern)
     {
-        if (n.row != 0) continue; // row 0 assumed = Kick
-        const int start16 = (n.startTick * 4) / BoomAudioProcessor::PPQ;
-        const int len16 = juce::jmax(1, (n.lengthTicks * 4) / BoomAudioProcessor::PPQ);
+        if (n.row != 0) continue; // row 0 = Kick
+        const int start16 = (n.startTick * 4) / PPQ;
+        const int len16 = juce::jmax(1, (n.lengthTicks * 4) / PPQ);
+        const float boost = juce::jmap((float)juce::jlimit(1, 127, n.velocity), 1.0f, 127.0f, 0.15f, 0.45f);
         for (int s = 0; s < len16; ++s)
         {
             const int idx = start16 + s;
-            if ((unsigned)idx < bias.size())
-                bias[idx] = juce::jlimit(0, 100, bias[idx] + juce::jmap(n.velocity, 1, 127, 15, 45));
+            if ((unsigned)idx < total16)
+                kickBias[(size_t)idx] = juce::jmin(1.0f, kickBias[(size_t)idx] + boost);
         }
 
-        // also nudge neighbors (so we "tend" toward kicks without being locked)
         const int pre = start16 - 1;
         const int pst = start16 + len16;
-        if (pre >= 0)              bias[pre] = juce::jmax(bias[pre], 12);
-        if (pst < (int)bias.size()) bias[pst] = juce::jmax(bias[pst], 12);
+        if (pre >= 0 && (size_t)pre < total16) kickBias[(size_t)pre] = juce::jmax(kickBias[(size_t)pre], 0.12f);
+        if (pst >= 0 && (size_t)pst < total16) kickBias[(size_t)pst] = juce::jmax(kickBias[(size_t)pst], 0.12f);
     }
 
-    // tiny baseline so an empty kick lane still generates:
-    for (auto& b : bias) b = juce::jmax(b, 6);
-    return bias;
+    for (auto& v : kickBias) v = juce::jmax(v, 0.06f);
+    kickBiasVersion = drumPatternVersion;
+    return kickBias;
+}
+
+float BoomAudioProcessor::getKickCoupling() const noexcept
+{
+    if (auto* v = apvts.getRawParameterValue("kickCoupling"))
+        return juce::jlimit(-1.0f, 1.0f, v->load() / 100.0f);
+    return 0.0f;
 }
 
 double BoomAudioProcessor::getHostBpm() const noexcept
@@ -1246,103 +1445,21 @@ double BoomAudioProcessor::getHostBpm() const noexcept
 
 void BoomAudioProcessor::generateDrumRolls(const juce::String& style, int bars)
 {
-    auto pat = getDrumPattern();
-    pat.clear();
-
-    const int total16 = q16(bars);
-
-    auto add = [&](int row, int step16, int len16, int vel)
-    {
-        pat.add({ 0, row, toTick16(step16), toTick16(len16), vel });
-    };
-
-    // We’ll target the snare row = 1 for “rolls”; add supportive hats row=2
-    int rollRow = 1, hatRow = 2;
-
-    if (style.compareIgnoreCase("trap") == 0)
-    {
-        // dense cresc/dim + 32nd trills sprinkled
-        for (int b = 0; b < bars; ++b)
-        {
-            const int start = b * 16;
-            for (int i = 0; i < 16; ++i)
-            {
-                if (i % 2 == 0 || chance(35)) add(hatRow, start + i, 1, irand(60, 85));
-                if (chance(25))          add(rollRow, start + i, 1, irand(80, 110));
-                if (chance(10) && i < 15)  add(rollRow, start + i + 1, 1, irand(70, 95)); // 32nd-feel echo
-            }
-        }
-    }
-    else if (style.compareIgnoreCase("drill") == 0)
-    {
-        // triplet-y rolls & late snares (beat 4 of bar 2/4 feel)
-        for (int b = 0; b < bars; ++b)
-        {
-            const int start = b * 16;
-            // strong “late” accent near beat 4 (index 12)
-            add(rollRow, start + 12, 1, irand(100, 120));
-            for (int t = 0; t < 6; ++t) // triplet grid approx (16th-triplet-ish)
-            {
-                int p = start + (t * 2);
-                if (p < start + 16 && chance(60)) add(rollRow, p, 1, irand(75, 100));
-            }
-            for (int i = 0; i < 16; ++i)
-                if (i % 2 == 0 || chance(20)) add(hatRow, start + i, 1, irand(60, 85));
-        }
-    }
-    else if (style.compareIgnoreCase("edm") == 0)
-    {
-        // classic build: 1/4 -> 1/8 -> 1/16 -> 1/32 across bars
-        int seg = bars * 16;
-        int a = seg / 4, b = seg / 4, c = seg / 4, d = seg - (a + b + c);
-        auto stamp = [&](int every16, int begin, int count)
-        {
-            for (int i = 0; i < count; i++)
-            {
-                int base = begin + i * every16;
-                if (base < total16) add(rollRow, base, 1, irand(85, 115));
-            }
-        };
-        stamp(4, 0, a / 4);              // quarters
-        stamp(2, a, b / 2);              // eighths
-        stamp(1, a + b, c);              // sixteenths
-        for (int i = 0; i < d; ++i)        // 32nd-ish final rush: double up
-        {
-            add(rollRow, a + b + c + i, 1, irand(95, 120));
-            if (chance(70) && a + b + c + i + 1 < total16) add(rollRow, a + b + c + i + 1, 1, irand(85, 110));
-        }
-    }
-    else if (style.compareIgnoreCase("wxstie") == 0)
-    {
-        // sparser + choppy accents
-        for (int b = 0; b < bars; ++b)
-        {
-            int start = b * 16;
-            for (int i = 0; i < 16; ++i)
-                if (chance(30)) add(rollRow, start + i, 1, irand(80, 110));
-            for (int q = 0; q < 4; ++q)
-                if (chance(60)) add(hatRow, start + q * 4, 1, irand(70, 95));
-        }
-    }
-    else // pop / r&b / rock / reggaeton – tasteful single-bar fills
-    {
-        for (int b = 0; b < bars; ++b)
-        {
-            int start = b * 16;
-            for (int i = 0; i < 16; ++i)
-                if (chance(25)) add(rollRow, start + i, 1, irand(80, 105));
-            // end-bar push
-            add(rollRow, start + 14, 1, irand(95, 115));
-            add(rollRow, start + 15, 1, irand(95, 115));
-        }
-    }
+    // Rolls and fills alone, on an empty grid
+    boom::rolls::Result rolls;
+    boom::rolls::generate(boom::rulesForStyle(style), bars, nextSeedKey(boom::seed::Op::Rolls).toInt(), rolls);
 
-    setDrumPattern(pat);
+    Pattern pat;
+    boom::rolls::mergeInto(pat, rolls);
+    const auto& drumLocks = getLocks(boom::Engine::Drums);
+    if (drumLocks.any()) drumLocks.splice(getDrumPattern(), pat, boom::rolls::kBarTicks, true); // locked rows / bars stay
+    setDrumPattern(std::move(pat));
     notifyPatternChanged();
 }
 
 void BoomAudioProcessor::generateDrums(int bars)
 {
+    prng.setSeed(nextSeedKey(boom::seed::Op::Generate).derive());
     auto pat = getDrumPattern();
     pat.clear();
 
@@ -1383,8 +1500,9 @@ void BoomAudioProcessor::generateDrums(int bars)
 }
 
 
-void BoomAudioProcessor::flipMelodic(int densityPct, int addPct, int removePct)
+void BoomAudioProcessor::flipMelodic(int seed, int addPct, int removePct)
 {
+    prng.setSeed((std::uint64_t)(std::uint32_t)resolveSeed(seed, boom::seed::Op::Flip));
     auto pat = getMelodicPattern();
 
     // remove some
@@ -1401,7 +1519,7 @@ void BoomAudioProcessor::flipMelodic(int densityPct, int addPct, int removePct)
             const int  off16 = before ? -1 : 1;
             int start16 = (n.startTick / (PPQ / 4)) + off16;
             if (start16 >= 0)
-                pat.add({ n.pitch + (chance(50) ? 0 : (chance(50) ? 1 : -1)),
+                pat.add({ n.pitch + (chance(50) ? 0 : (chance(50) ? 1 : -1)), 0,
                           toTick16(start16), toTick16(1), juce::jlimit(40,120, n.velocity - 10), n.channel });
         }
     }
@@ -1410,8 +1528,9 @@ void BoomAudioProcessor::flipMelodic(int densityPct, int addPct, int removePct)
     notifyPatternChanged();
 }
 
-void BoomAudioProcessor::flipDrums(int densityPct, int addPct, int removePct)
+void BoomAudioProcessor::flipDrums(int seed, int addPct, int removePct)
 {
+    prng.setSeed((std::uint64_t)(std::uint32_t)resolveSeed(seed, boom::seed::Op::Flip));
     auto pat = getDrumPattern();
 
     // remove
@@ -1437,37 +1556,17 @@ void BoomAudioProcessor::flipDrums(int densityPct, int addPct, int removePct)
 
 void BoomAudioProcessor::generateRolls(const juce::String& style, int bars, int seed)
 {
-    std::mt19937 rng(seed == -1 ? std::random_device{}() : (unsigned)seed);
-
-    int restPct = 10;
-    const int dottedPct = getPct(apvts, "dottedDensity", 0);
-    int       tripletPct = getPct(apvts, "tripletDensity", 0);
-    const int swingPct = getPct(apvts, "swing", 0);
-    if (style.equalsIgnoreCase("drill")) tripletPct = clampInt(tripletPct + 20, 0, 100);
-
-    boom::drums::DrumStyleSpec spec = boom::drums::getSpec(style);
-    boom::drums::DrumPattern pat;
-    boom::drums::generate(spec, bars, restPct, dottedPct, tripletPct, swingPct, /*seed*/ -1, pat);
-
-    auto cur = getDrumPattern();
-    juce::Array<Note> out = cur;
-
-    const int hatRow = 1; // adjust to your indices
-    const int snareRow = 2;
-
-    for (const auto& e : pat)
-    {
-        if (e.row == hatRow || e.row == snareRow)
-        {
-            Note dn;
-            dn.row = e.row;
-            dn.startTick = e.startTick;
-            dn.lengthTicks = e.lenTicks;
-            dn.velocity = juce::jlimit<int>(1, 127, e.vel);
-            out.add(dn);
-        }
-    }
-    setDrumPattern(out);
+    // Hat rolls, ghost snares and phrase-end fills from the style's rules, merged into one copy
+    // of the current drums (in-roll notes of the rolled row give way; the result stays sorted).
+    // Locked rows and bars keep the current notes, as with every other drum writer.
+    boom::rolls::Result rolls;
+    boom::rolls::generate(boom::rulesForStyle(style), bars, resolveSeed(seed, boom::seed::Op::Rolls), rolls);
+
+    Pattern out = getDrumPattern();
+    boom::rolls::mergeInto(out, rolls);
+    const auto& drumLocks = getLocks(boom::Engine::Drums);
+    if (drumLocks.any()) drumLocks.splice(getDrumPattern(), out, boom::rolls::kBarTicks, true);
+    setDrumPattern(std::move(out));
 }
 
 int BoomAudioProcessor::getTimeSigNumerator() const noexcept
@@ -1484,6 +1583,18 @@ int BoomAudioProcessor::getTimeSigDenominator() const noexcept
     return 4;
 }
 
+int BoomAudioProcessor::getBars() const
+{
+    // "bars" is a choice param, so map the index back through the choice list
+    if (auto* v = apvts.getRawParameterValue("bars"))
+    {
+        const auto& choices = boom::barsChoices();
+        const int idx = juce::jlimit(0, choices.size() - 1, (int)std::lround(v->load()));
+        return juce::jmax(1, choices[idx].getIntValue());
+    }
+    return 4;
+}
+
 
 // --- Timer tick: refresh the BPM label (and anything else lightweight) ---
 void BoomAudioProcessor::prepareToPlay(double sampleRate, int /*samplesPerBlock*/)
@@ -1494,7 +1605,26 @@ void BoomAudioProcessor::prepareToPlay(double sampleRate, int /*samplesPerBlock*
     captureBuffer.clear(); // ~60s cap + a little margin
     captureWritePos = 0;
     captureLengthSamples = 0;
+    captureTotalWritten.store(0);
     isCapturing.store(false);
+    isPreviewing.store(false);
+    previewReadPos.store(0);
+    pendingPreviewSeek.store(-1);
+    previewFadeRemaining = 0;
+    previewFadeLength = juce::jmax(32, (int)std::round(0.005 * lastSampleRate));
+
+    // Pre-render the preview clicks so the audio thread only mixes them in
+    auto renderClick = [this](std::vector<float>& dst, double freqHz, float gain)
+    {
+        dst.resize((size_t)juce::jmax(1, (int)std::round(0.012 * lastSampleRate)));
+        for (size_t i = 0; i < dst.size(); ++i)
+        {
+            const double t = (double)i / lastSampleRate;
+            dst[i] = gain * (float)(std::exp(-t * 400.0) * std::sin(juce::MathConstants<double>::twoPi * freqHz * t));
+        }
+    };
+    renderClick(clickNormal, 1800.0, 0.35f);
+    renderClick(clickAccent, 2700.0, 0.55f);
 }
 
 // IMPORTANT: This is where we append input audio to the capture ring buffer when recording.
@@ -1507,19 +1637,27 @@ void BoomAudioProcessor::processBlock(juce::AudioBuffer<float>& buffer,
     // --- 1) Keep our sample-rate fresh --------------------------------------
     lastSampleRate = getSampleRate() > 0.0 ? getSampleRate() : lastSampleRate;
 
-    // --- 2) Poll host for BPM (JUCE 7/8 safe) -------------------------------
+    // --- 2) Poll host for BPM + transport (JUCE 7/8 safe) -------------------
+    bool   hostPlaying = false, haveHostPpq = false;
+    double hostPpq = 0.0;
+    int    hostTsNum = 4, hostTsDen = 4;
     if (auto* ph = getPlayHead())
     {
         if (auto pos = ph->getPosition())
         {
             if (pos->getBpm().hasValue())
                 lastHostBpm = *pos->getBpm();   // <-- make sure you have 'double lastHostBpm' in your class
-            // If you want time sig too (only if you have members for them):
-            // if (pos->getTimeSignature().has_value()) {
-            //     auto ts = *pos->getTimeSignature();
-            //     lastTimeSigNum = ts.numerator;
-            //     lastTimeSigDen = ts.denominator;
-            // }
+            if (pos->getPpqPosition().hasValue())
+            {
+                hostPpq = *pos->getPpqPosition();
+                haveHostPpq = true;
+            }
+            if (pos->getTimeSignature().hasValue())
+            {
+                hostTsNum = juce::jmax(1, pos->getTimeSignature()->numerator);
+                hostTsDen = juce::jmax(1, pos->getTimeSignature()->denominator);
+            }
+            hostPlaying = pos->getIsPlaying();
         }
     }
 
@@ -1552,8 +1690,44 @@ void BoomAudioProcessor::processBlock(juce::AudioBuffer<float>& buffer,
     rmsInputL.store(rmsL);
     rmsInputR.store(rmsR);
 
+    // Armed take: wait for the next bar line on the host timeline, then start writing from that sample
+    int captureOffset = 0;
+    if (captureArmed.load(std::memory_order_acquire) && numSmps > 0)
+    {
+        const double bpm = lastHostBpm.load();
+        if (hostPlaying && haveHostPpq && bpm > 0.0)
+        {
+            const double barQ = hostTsNum * 4.0 / hostTsDen;   // quarter notes per bar
+            const double nextBar = std::ceil(hostPpq / barQ - 1.0e-9) * barQ;
+            const double samplesPerQ = lastSampleRate * 60.0 / bpm;
+            const int toBar = (int)std::llround((nextBar - hostPpq) * samplesPerQ);
+
+            if (toBar < numSmps)
+            {
+                const int cap = captureBuffer.getNumSamples();
+                captureOffset = juce::jmax(0, toBar);
+                int layerLen = 0, maxLayers = 0;
+                if (captureLoopBars > 0 && cap > 0)
+                {
+                    layerLen = juce::jlimit(1, cap, (int)std::llround(captureLoopBars * barQ * samplesPerQ));
+                    maxLayers = juce::jmax(1, cap / layerLen);
+                }
+                captureLayerLen.store(layerLen, std::memory_order_release);
+                captureMaxLayers.store(maxLayers, std::memory_order_release);
+                captureStartBpm.store(bpm);
+                captureSynced.store(true);
+                captureArmed.store(false);
+                isCapturing.store(true, std::memory_order_release);
+            }
+        }
+    }
+
+    // Synced takes end with the host transport
+    if (captureSynced.load() && isCapturing.load() && !hostPlaying)
+        isCapturing.store(false);
+
     // If we’re actively capturing, push audio into our mono ring buffer
-    if (isCapturing.load() && numSmps > 0 && numInCh > 0)
+    if (isCapturing.load() && numSmps > captureOffset && numInCh > 0)
     {
         // Ensure capacity: at least ~65 seconds of mono at current SR
         const int want = (int)std::ceil(lastSampleRate * 65.0);
@@ -1562,6 +1736,7 @@ void BoomAudioProcessor::processBlock(juce::AudioBuffer<float>& buffer,
             captureBuffer.setSize(1, want, false, true, true);
             captureWritePos = 0;
             captureLengthSamples = 0;
+            captureTotalWritten.store(0);
         }
 
         float* dst = captureBuffer.getWritePointer(0);
@@ -1570,17 +1745,44 @@ void BoomAudioProcessor::processBlock(juce::AudioBuffer<float>& buffer,
 
         const int cap = captureBuffer.getNumSamples();
 
-        // Write as a wrap-around ring
-        for (int i = 0; i < numSmps; ++i)
+        const int layerLen = captureLayerLen.load(std::memory_order_acquire);
+        if (layerLen > 0)
+        {
+            // Loop record: write linearly, one layer slot after another, and stop once every slot is full
+            const int storeEnd = juce::jmin(cap, layerLen * captureMaxLayers.load(std::memory_order_acquire));
+            const int n = juce::jmin(numSmps - captureOffset, storeEnd - captureWritePos);
+            for (int i = 0; i < n; ++i)
+            {
+                const int s = captureOffset + i;
+                dst[captureWritePos + i] = inR ? 0.5f * (inL[s] + inR[s]) : inL[s];
+            }
+
+            captureWritePos += juce::jmax(0, n);
+            captureLengthSamples = captureWritePos;
+            captureTotalWritten.fetch_add(juce::jmax(0, n), std::memory_order_release);
+            captureLayersDone.store(captureWritePos / layerLen, std::memory_order_release);
+
+            if (captureWritePos >= storeEnd)
+            {
+                if (captureWritePos >= cap) captureWritePos = 0;
+                isCapturing.store(false);
+            }
+        }
+        else
         {
-            const float mono = inR ? 0.5f * (inL[i] + inR[i]) : inL[i];
-            dst[captureWritePos] = mono;
+            // Write as a wrap-around ring
+            for (int i = captureOffset; i < numSmps; ++i)
+            {
+                const float mono = inR ? 0.5f * (inL[i] + inR[i]) : inL[i];
+                dst[captureWritePos] = mono;
 
-            captureWritePos = (captureWritePos + 1);
-            if (captureWritePos >= cap) captureWritePos = 0;
+                captureWritePos = (captureWritePos + 1);
+                if (captureWritePos >= cap) captureWritePos = 0;
 
-            if (captureLengthSamples < cap)
-                ++captureLengthSamples;
+                if (captureLengthSamples < cap)
+                    ++captureLengthSamples;
+            }
+            captureTotalWritten.fetch_add(numSmps - captureOffset, std::memory_order_release);
         }
 
         // Advance a lightweight "playhead" so the seekbar can move during record
@@ -1592,13 +1794,18 @@ void BoomAudioProcessor::processBlock(juce::AudioBuffer<float>& buffer,
         capturePlayheadSamples.store(0);
     }
 
-    // --- 4) MIDI: leave 'midi' alone here -----------------------------------
+    // --- 4) Capture preview (Play in AI Tools) ------------------------------
+    // Replaces the output with the captured take from the preview read head.
+    if (isPreviewing.load(std::memory_order_acquire))
+        renderCapturePreview(buffer);
+
+    // --- 5) MIDI: leave 'midi' alone here -----------------------------------
     // Your generators run from UI callbacks and update internal patterns.
     // If you later want to emit MIDI every block (to drive external synths),
     // you’d translate your current pattern into 'midi' here based on the host time.
     // For now, do nothing so we don’t double-fire notes.
 
-    // --- 5) If you are an instrument, you *may* want to output silence -------
+    // --- 6) If you are an instrument, you *may* want to output silence -------
     // If this plugin is a synth with no audio generation inside processBlock,
     // uncomment to avoid passing through input:
     // buffer.clear();
@@ -1607,7 +1814,9 @@ void BoomAudioProcessor::processBlock(juce::AudioBuffer<float>& buffer,
 void BoomAudioProcessor::releaseResources()
 {
     // Nothing heavy to free, but make sure capture is stopped and pointers reset.
+    captureArmed.store(false);
     isCapturing.store(false);
+    isPreviewing.store(false);
     captureWritePos = 0;
     captureLengthSamples = 0;
 }
@@ -1644,12 +1853,33 @@ void BoomAudioProcessor::appendCaptureFrom(const juce::AudioBuffer<float>& in)
         isCapturing.store(false);
 }
 
-BoomAudioProcessor::Pattern BoomAudioProcessor::transcribeAudioToDrums(const float* mono, int N, int bars, int bpm) const
+BoomAudioProcessor::TranscribeSettings BoomAudioProcessor::transcribeSettings() const
+{
+    TranscribeSettings t;
+    t.sampleRate = lastSampleRate;
+    if (const auto* hpssParam = apvts.getRawParameterValue("hpssEnabled"))
+        t.hpss = hpssParam->load() > 0.5f;
+
+    auto sens = [this](const char* id)
+    {
+        if (auto* v = apvts.getRawParameterValue(id))
+            return juce::jlimit(0.0f, 1.0f, v->load() / 100.0f);
+        return 0.5f;
+    };
+    t.sensKick = sens("onsetSensKick");
+    t.sensSnare = sens("onsetSensSnare");
+    t.sensHat = sens("onsetSensHat");
+    return t;
+}
+
+BoomAudioProcessor::Pattern BoomAudioProcessor::transcribeAudioToDrums(const float* mono, int N, int bars, int bpm,
+                                                                       const TranscribeSettings& settings,
+                                                                       std::vector<CaptureOnset>* onsets)
 {
     Pattern pat;
     if (mono == nullptr || N <= 0) return pat;
 
-    const int fs = (int)lastSampleRate;
+    const int fs = (int)settings.sampleRate;
     const int hop = 512;
     const int win = 1024;
     const float preEmph = 0.97f;
@@ -1680,35 +1910,45 @@ BoomAudioProcessor::Pattern BoomAudioProcessor::transcribeAudioToDrums(const flo
             env.push_back(e);
         }
 
-        float mx = 1e-6f;
-        for (auto v : env) mx = juce::jmax(mx, v);
-        for (auto& v : env) v /= mx;
-
         return env;
     };
 
-    auto low = bandEnergy(20, 200);
-    auto mid = bandEnergy(200, 2000);
-    auto high = bandEnergy(5000, 20000);
+    std::vector<float> low, mid, high;
+    if (settings.hpss)
+    {
+        // Real band energies from the percussive part of the spectrogram, so sustained bass
+        // and vocals in a full mix stop reading as kicks and snares. Same 1024/512 framing.
+        const auto spec = boom::hpss::stftMagnitude(mono, N, 10, hop);
+        const auto perc = boom::hpss::percussive(spec);
+        low = boom::hpss::bandEnvelope(perc, fs, 20.0f, 200.0f);
+        mid = boom::hpss::bandEnvelope(perc, fs, 200.0f, 2000.0f);
+        high = boom::hpss::bandEnvelope(perc, fs, 5000.0f, 20000.0f);
+    }
+    else
+    {
+        low = bandEnergy(20, 200);
+        mid = bandEnergy(200, 2000);
+        high = bandEnergy(5000, 20000);
+    }
 
-    auto detectPeaks = [&](const std::vector<float>& e, float thr, int minGapFrames)
+    // Local adaptive thresholds (sliding median/p90 over ~0.75 s), so one loud hit no longer
+    // hides the quiet ones and the picker could run on frames as they arrive.
+    const int thrWindowFrames = juce::jmax(8, (int)std::round(0.75 * fs / hop));
+    auto detectPeaks = [&](const std::vector<float>& e, float sens, int minGapFrames)
     {
+        boom::onset::AdaptivePeakPicker picker(thrWindowFrames, juce::jmax(1, minGapFrames), sens);
         std::vector<int> frames;
-        int last = -minGapFrames;
-        for (int i = 1; i + 1 < (int)e.size(); ++i)
+        for (auto v : e)
         {
-            if (e[i] > thr && e[i] > e[i - 1] && e[i] >= e[i + 1] && (i - last) >= minGapFrames)
-            {
-                frames.push_back(i);
-                last = i;
-            }
+            const int f = picker.push(v);
+            if (f >= 0) frames.push_back(f);
         }
         return frames;
     };
 
-    auto kFrames = detectPeaks(low, 0.35f, (int)std::round(0.040 * fs / hop));
-    auto sFrames = detectPeaks(mid, 0.30f, (int)std::round(0.050 * fs / hop));
-    auto hFrames = detectPeaks(high, 0.28f, (int)std::round(0.030 * fs / hop));
+    auto kFrames = detectPeaks(low, settings.sensKick, (int)std::round(0.040 * fs / hop));
+    auto sFrames = detectPeaks(mid, settings.sensSnare, (int)std::round(0.050 * fs / hop));
+    auto hFrames = detectPeaks(high, settings.sensHat, (int)std::round(0.030 * fs / hop));
 
     auto frameToTick = [&](int frame) -> int
     {
@@ -1721,7 +1961,11 @@ BoomAudioProcessor::Pattern BoomAudioProcessor::transcribeAudioToDrums(const flo
     auto addHits = [&](const std::vector<int>& frames, int row, int vel)
     {
         for (auto f : frames)
+        {
             pat.add({ 0, row, frameToTick(f), 12, vel });
+            if (onsets != nullptr)
+                onsets->push_back({ f * hop, row });
+        }
     };
 
     // rows: 0 kick, 1 snare, 2 hat
@@ -1732,19 +1976,202 @@ BoomAudioProcessor::Pattern BoomAudioProcessor::transcribeAudioToDrums(const flo
     return pat;
 }
 
+// Transcription runs on its own worker (HPSS alone is ~0.6 s on a 60 s take, and a loop
+// record runs one transcription per pass). The samples and the parameters are copied here; the
+// pattern and the overview onsets are applied in applyTranscription.
 void BoomAudioProcessor::aiAnalyzeCapturedToDrums(int bars, int bpm)
 {
     if (captureLengthSamples <= 0) return;
-    const int N = juce::jmin(captureLengthSamples, captureBuffer.getNumSamples());
-    auto* mono = captureBuffer.getReadPointer(0);
-    auto pat = transcribeAudioToDrums(mono, N, bars, bpm);
-    setDrumPattern(pat);
+
+    // Bar-synced takes know their real tempo, so that beats whatever the UI passed in
+    const double syncedBpm = captureStartBpm.load();
+    if (syncedBpm > 0.0)
+        bpm = (int)std::lround(syncedBpm);
+
+    // Loop-recorded takes: transcribe every finished pass, then keep what most passes agree on
+    if (captureLayersDone.load(std::memory_order_acquire) > 0)
+    {
+        requestTranscription(captureLoopBars, bpm, true);
+        return;
+    }
+
+    requestTranscription(bars, bpm, false);
+}
+
+namespace
+{
+    // A transcribed take as a flat [row * steps + step] hit grid (0 = no hit, else velocity)
+    std::vector<int> layerHitGrid(const BoomAudioProcessor::Pattern& p, int rows, int steps)
+    {
+        std::vector<int> grid((size_t)(rows * steps), 0);
+        for (const auto& n : p)
+        {
+            const int step = n.startTick / 24;
+            if (juce::isPositiveAndBelow(n.row, rows) && juce::isPositiveAndBelow(step, steps))
+                grid[(size_t)(n.row * steps + step)] = juce::jmax(1, n.velocity);
+        }
+        return grid;
+    }
+
+    constexpr int kLayerRows = 3; // transcription only emits kick / snare / hat
+}
+
+void BoomAudioProcessor::aiAnalyzeCaptureLayers(int bars, int bpm)
+{
+    requestTranscription(bars, bpm, false, true);
+}
+
+std::uint64_t BoomAudioProcessor::requestTranscription(int bars, int bpm, bool consensus, bool layersOnly)
+{
+    const bool layered = consensus || layersOnly;
+    const int layers = layered ? captureLayersDone.load(std::memory_order_acquire) : 0;
+    const int layerLen = captureLayerLen.load(std::memory_order_acquire); // published before the layers it sizes
+    if (layered && (layers <= 0 || layerLen <= 0))
+    {
+        layerTakes.clear();
+        bestLayer = -1;
+        return 0;
+    }
+
+    // Snapshot: the capture range as it is now (a new take may start while the worker runs)
+    const int N = layered ? juce::jmin(layers * layerLen, captureBuffer.getNumSamples())
+                          : juce::jmin(captureLengthSamples, captureBuffer.getNumSamples());
+    if (N <= 0) return 0;
+    const float* src = captureBuffer.getReadPointer(0);
+    std::vector<float> mono(src, src + N);
+
+    const auto settings = transcribeSettings();
+    const int cap = captureBuffer.getNumSamples(), readStart = captureReadStart();
+    const std::uint32_t take = captureTake;
+    bpm = juce::jlimit(40, 240, bpm);
+
+    return transcriber.submit([mono = std::move(mono), N, bars, bpm, settings, layered, layers, layerLen, cap, readStart,
+                               take, consensus](const auto& cancelled, Transcription& out)
+    {
+        out.captureTake = take;
+        out.gridBpm = bpm;
+        out.useConsensus = consensus;
+
+        if (!layered)
+        {
+            out.pattern = transcribeAudioToDrums(mono.data(), N, bars, bpm, settings, &out.onsets);
+
+            // Onsets come back as buffer indices; the overview draws logical (oldest-first) positions
+            for (auto& o : out.onsets)
+                o.sample = cap > 0 ? (o.sample - readStart + cap) % cap : o.sample;
+            return true;
+        }
+
+        out.layerTakeSteps = juce::jmax(1, bars) * 16;
+        for (int k = 0; k < layers && (k + 1) * layerLen <= N; ++k)
+        {
+            if (cancelled()) return false;
+            const size_t first = out.onsets.size();
+            out.layerTakes.push_back(transcribeAudioToDrums(mono.data() + (size_t)k * (size_t)layerLen, layerLen, bars, bpm,
+                settings, &out.onsets));
+            for (size_t i = first; i < out.onsets.size(); ++i)
+                out.onsets[i].sample += k * layerLen;   // layers sit back to back from sample 0
+        }
+        out.bestLayer = bestLayerOf(out.layerTakes, out.layerTakeSteps);
+        return true;
+    });
+}
+
+// Best pass = highest summed overlap (hits in both / hits in either) with every other pass
+int BoomAudioProcessor::bestLayerOf(const std::vector<Pattern>& takes, int steps)
+{
+    const int layers = (int)takes.size();
+    std::vector<std::vector<int>> grids;
+    for (const auto& t : takes)
+        grids.push_back(layerHitGrid(t, kLayerRows, steps));
+
+    int best = -1;
+    double bestScore = -1.0;
+    for (int a = 0; a < layers; ++a)
+    {
+        double score = 0.0;
+        for (int b = 0; b < layers; ++b)
+        {
+            if (a == b) continue;
+            int both = 0, either = 0;
+            for (size_t c = 0; c < grids[(size_t)a].size(); ++c)
+            {
+                const bool ha = grids[(size_t)a][c] > 0, hb = grids[(size_t)b][c] > 0;
+                both += (ha && hb);
+                either += (ha || hb);
+            }
+            score += either > 0 ? (double)both / either : 1.0;
+        }
+        if (score > bestScore) { bestScore = score; best = a; }
+    }
+    return best;
+}
+
+void BoomAudioProcessor::applyTranscription(Transcription&& r)
+{
+    if (r.captureTake != captureTake) return; // a new take started meanwhile: the result is about the old one
+
+    captureOnsets = std::move(r.onsets);
+    previewGridBpm.store(r.gridBpm); // preview click follows the grid we just used
+
+    if (r.layerTakeSteps > 0)
+    {
+        layerTakes = std::move(r.layerTakes);
+        layerTakeSteps = r.layerTakeSteps;
+        bestLayer = r.bestLayer;
+        if (r.useConsensus) aiUseConsensusTake();
+    }
+    else
+    {
+        setDrumPattern(std::move(r.pattern));
+    }
+
+    if (onGenerated) onGenerated(boom::Engine::Drums);
+}
+
+bool BoomAudioProcessor::aiUseLayerTake(int layer)
+{
+    if (!juce::isPositiveAndBelow(layer, (int)layerTakes.size()))
+        return false;
+
+    setDrumPattern(layerTakes[(size_t)layer]);
+    return true;
+}
+
+void BoomAudioProcessor::aiUseConsensusTake(float minAgreement)
+{
+    if (layerTakes.empty() || layerTakeSteps <= 0) return;
+
+    const int layers = (int)layerTakes.size();
+    const int need = juce::jlimit(1, layers, (int)std::ceil(juce::jlimit(0.0f, 1.0f, minAgreement) * layers));
+
+    // Count every (row, step) across the passes and average the velocities of the ones that were found
+    std::vector<int> count((size_t)(kLayerRows * layerTakeSteps), 0), velSum(count.size(), 0);
+    for (const auto& t : layerTakes)
+    {
+        const auto grid = layerHitGrid(t, kLayerRows, layerTakeSteps);
+        for (size_t c = 0; c < grid.size(); ++c)
+            if (grid[c] > 0) { ++count[c]; velSum[c] += grid[c]; }
+    }
+
+    Pattern out;
+    for (int row = 0; row < kLayerRows; ++row)
+        for (int step = 0; step < layerTakeSteps; ++step)
+        {
+            const size_t c = (size_t)(row * layerTakeSteps + step);
+            if (count[c] >= need)
+                out.add({ 0, row, step * 24, 12, juce::jlimit(1, 127, velSum[c] / count[c]) });
+        }
+
+    setDrumPattern(out);
 }
 
 void BoomAudioProcessor::aiStartCapture(CaptureSource src)
 {
-    // Stop any previous capture first
+    // Stop any previous capture (and its preview) first
     aiStopCapture();
+    aiPreviewStop();
+    previewReadPos.store(0);
 
     // Remember what we’re capturing (Loopback or Microphone — your enum has only those two)
     currentCapture = src;
@@ -1756,14 +2183,64 @@ void BoomAudioProcessor::aiStartCapture(CaptureSource src)
     captureWritePos = 0;
     captureLengthSamples = 0;
 
+    // Free take: no bar sync, no layers
+    captureSynced.store(false);
+    captureStartBpm.store(0.0);
+    captureLoopBars = 0;
+    captureLayerLen.store(0, std::memory_order_release);
+    captureMaxLayers.store(0, std::memory_order_release);
+    captureLayersDone.store(0);
+    layerTakes.clear();
+    bestLayer = -1;
+    captureTotalWritten.store(0);
+    waveform.reset(captureBuffer.getNumSamples());
+    waveformConsumed = 0;
+    captureOnsets.clear();
+    ++captureTake; // transcriptions still running belong to the previous take
+
     // Mark as capturing
     isCapturing.store(true, std::memory_order_release);
 
     if (auto* ed = getActiveEditor()) ed->repaint();
 }
 
+void BoomAudioProcessor::aiArmCapture(CaptureSource src, int loopBars)
+{
+    aiStopCapture();
+    aiPreviewStop();
+    previewReadPos.store(0);
+
+    currentCapture = src;
+
+    lastSampleRate = getSampleRate() > 0.0 ? getSampleRate() : lastSampleRate;
+    ensureCaptureCapacitySeconds(65.0);
+    captureBuffer.clear();
+    captureWritePos = 0;
+    captureLengthSamples = 0;
+
+    captureSynced.store(false);
+    captureStartBpm.store(0.0);
+    captureLoopBars = juce::jmax(0, loopBars);
+    captureLayerLen.store(0, std::memory_order_release);   // sized by the audio thread from the host tempo at the bar line
+    captureMaxLayers.store(0, std::memory_order_release);
+    captureLayersDone.store(0);
+    layerTakes.clear();
+    bestLayer = -1;
+    captureTotalWritten.store(0);
+    waveform.reset(captureBuffer.getNumSamples());
+    waveformConsumed = 0;
+    captureOnsets.clear();
+    ++captureTake; // transcriptions still running belong to the previous take
+
+    // processBlock flips this into isCapturing on the next bar line
+    captureArmed.store(true, std::memory_order_release);
+
+    if (auto* ed = getActiveEditor()) ed->repaint();
+}
+
 void BoomAudioProcessor::aiStopCapture()
 {
+    captureArmed.store(false);
     if (!isCapturing.load(std::memory_order_acquire))
         return;
 
@@ -1773,9 +2250,15 @@ void BoomAudioProcessor::aiStopCapture()
 
 void BoomAudioProcessor::aiPreviewStart()
 {
-    if (captureLengthSamples <= 0) return;
-    isPreviewing.store(true);
-    previewReadPos = 0;
+    if (captureLengthSamples <= 0 || isCapturing.load()) return;
+    if (isPreviewing.load()) return;
+
+    // Resume from wherever the seek bar left the read head; a finished preview restarts from the top.
+    if (previewReadPos.load() >= captureLengthSamples)
+        previewReadPos.store(0);
+    pendingPreviewSeek.store(-1);
+    previewFadeRemaining = 0;
+    isPreviewing.store(true, std::memory_order_release);
 }
 
 void BoomAudioProcessor::aiPreviewStop()
@@ -1793,15 +2276,197 @@ double BoomAudioProcessor::getCaptureLengthSeconds() const noexcept
 double BoomAudioProcessor::getCapturePositionSeconds() const noexcept
 {
     return (lastSampleRate > 0.0)
-        ? static_cast<double>(juce::jlimit(0, captureLengthSamples, previewReadPos)) / lastSampleRate
+        ? static_cast<double>(juce::jlimit(0, captureLengthSamples, previewReadPos.load())) / lastSampleRate
         : 0.0;
 }
 
 void BoomAudioProcessor::aiSeekToSeconds(double sec) noexcept
 {
     if (lastSampleRate <= 0.0 || captureLengthSamples <= 0) return;
-    const int target = (int)juce::jlimit(0.0, getCaptureLengthSeconds(), sec) * (int)lastSampleRate;
-    previewReadPos = juce::jlimit(0, captureLengthSamples, target);
+    const double clamped = juce::jlimit(0.0, getCaptureLengthSeconds(), sec);
+    const int target = juce::jlimit(0, captureLengthSamples, (int)std::llround(clamped * lastSampleRate));
+
+    // While previewing, the audio thread owns the read head: post the seek and let it crossfade there.
+    if (isPreviewing.load(std::memory_order_acquire))
+        pendingPreviewSeek.store(target, std::memory_order_release);
+    else
+        previewReadPos.store(target);
+}
+
+void BoomAudioProcessor::aiUpdateWaveform()
+{
+    const int cap = captureBuffer.getNumSamples();
+    if (cap <= 0) return;
+
+    // Buffer was resized (new sample rate): start the summary over from whatever is still in the ring
+    if (waveform.getCapacity() != cap)
+    {
+        waveform.reset(cap);
+        waveformConsumed = 0;
+    }
+
+    const juce::int64 total = captureTotalWritten.load(std::memory_order_acquire);
+    if (total < waveformConsumed)
+        waveformConsumed = 0;
+
+    // Every take writes from buffer index 0, so written sample i lives at i % cap;
+    // anything older than one full lap has been overwritten already.
+    const float* data = captureBuffer.getReadPointer(0);
+    juce::int64 from = juce::jmax(waveformConsumed, total - (juce::int64)cap);
+    while (from < total)
+    {
+        const int p = (int)(from % cap);
+        const int n = (int)juce::jmin<juce::int64>(total - from, (juce::int64)(cap - p));
+        waveform.update(data, p, p + n);
+        from += n;
+    }
+    waveformConsumed = total;
+}
+
+void BoomAudioProcessor::aiGetWaveformRange(int startSample, int endSample, float& mn, float& mx) const
+{
+    mn = mx = 0.0f;
+    const int cap = captureBuffer.getNumSamples();
+    const int len = juce::jmin(captureLengthSamples, cap);
+    startSample = juce::jlimit(0, len, startSample);
+    endSample = juce::jlimit(0, len, endSample);
+    if (cap <= 0 || startSample >= endSample) return;
+
+    // Logical range -> at most two physical spans of the ring
+    const float* data = captureBuffer.getReadPointer(0);
+    const int p0 = (captureReadStart() + startSample) % cap;
+    const int n = endSample - startSample;
+    const int first = juce::jmin(n, cap - p0);
+
+    waveform.query(data, p0, p0 + first, mn, mx);
+    if (first < n)
+    {
+        float mn2, mx2;
+        waveform.query(data, 0, n - first, mn2, mx2);
+        mn = juce::jmin(mn, mn2);
+        mx = juce::jmax(mx, mx2);
+    }
+}
+
+int BoomAudioProcessor::captureReadStart() const noexcept
+{
+    // Once the ring has wrapped, the oldest sample sits at the write position.
+    return captureLengthSamples >= captureBuffer.getNumSamples() ? captureWritePos : 0;
+}
+
+// Visit a logical range of the capture as contiguous spans of the ring (at most two),
+// so callers can use block copies instead of wrapping every sample.
+template <typename Fn>
+void BoomAudioProcessor::forEachCaptureSpan(int logicalPos, int count, Fn&& fn) const
+{
+    const int cap = captureBuffer.getNumSamples();
+    if (cap <= 0 || count <= 0) return;
+
+    int phys = (captureReadStart() + logicalPos) % cap;
+    int offset = 0;
+    while (count > 0)
+    {
+        const int n = juce::jmin(count, cap - phys);
+        fn(phys, offset, n);
+        offset += n;
+        count -= n;
+        phys = 0;
+    }
+}
+
+void BoomAudioProcessor::renderCapturePreview(juce::AudioBuffer<float>& out)
+{
+    const int numSmps = out.getNumSamples();
+    const int numCh = out.getNumChannels();
+    const int len = juce::jmin(captureLengthSamples, captureBuffer.getNumSamples());
+    if (numSmps <= 0 || numCh <= 0) return;
+    if (len <= 0 || captureBuffer.getNumChannels() < 1) { isPreviewing.store(false); return; }
+
+    int pos = juce::jlimit(0, len, previewReadPos.load(std::memory_order_relaxed));
+
+    // Seeks only land here, at block start, and crossfade from the old head so there is no click.
+    const int seek = pendingPreviewSeek.exchange(-1, std::memory_order_acq_rel);
+    if (seek >= 0)
+    {
+        previewFadeFromPos = pos;
+        previewFadeRemaining = (pos < len ? previewFadeLength : 0);
+        pos = juce::jlimit(0, len, seek);
+    }
+
+    out.clear();
+    float* dst = out.getWritePointer(0);
+    const float* src = captureBuffer.getReadPointer(0);
+
+    const int toPlay = juce::jmin(numSmps, len - pos);
+    forEachCaptureSpan(pos, toPlay, [&](int phys, int offset, int n)
+    {
+        juce::FloatVectorOperations::copy(dst + offset, src + phys, n);
+    });
+
+    if (previewFadeRemaining > 0)
+    {
+        const int n = juce::jmin(previewFadeRemaining, numSmps);
+        const float fadeLen = (float)previewFadeLength;
+        const float gIn0 = 1.0f - (float)previewFadeRemaining / fadeLen;
+        const float gIn1 = 1.0f - (float)(previewFadeRemaining - n) / fadeLen;
+
+        // new head fades in...
+        out.applyGainRamp(0, 0, n, gIn0, gIn1);
+
+        // ...while the old head fades out underneath it
+        const int oldN = juce::jmin(n, len - previewFadeFromPos);
+        forEachCaptureSpan(previewFadeFromPos, oldN, [&](int phys, int offset, int m)
+        {
+            const float gs = 1.0f - juce::jmap((float)offset, 0.0f, (float)n, gIn0, gIn1);
+            const float ge = 1.0f - juce::jmap((float)(offset + m), 0.0f, (float)n, gIn0, gIn1);
+            out.addFromWithRamp(0, offset, src + phys, m, gs, ge);
+        });
+
+        previewFadeFromPos += n;
+        previewFadeRemaining -= n;
+    }
+
+    if (previewClickEnabled.load(std::memory_order_relaxed) && toPlay > 0)
+        addPreviewClicks(dst, pos, toPlay);
+
+    for (int ch = 1; ch < numCh; ++ch)
+        out.copyFrom(ch, 0, out, 0, 0, numSmps);
+
+    pos += toPlay;
+    if (pos >= len)
+    {
+        // End of take: park at the top so the next Play starts over
+        pos = 0;
+        previewFadeRemaining = 0;
+        isPreviewing.store(false, std::memory_order_release);
+    }
+    previewReadPos.store(pos, std::memory_order_relaxed);
+}
+
+void BoomAudioProcessor::addPreviewClicks(float* dst, int logicalStart, int numSamples) const
+{
+    const int gridBpm = previewGridBpm.load(std::memory_order_relaxed);
+    const double bpm = gridBpm > 0 ? (double)gridBpm : lastHostBpm.load();
+    if (bpm <= 0.0 || clickNormal.empty() || clickAccent.empty()) return;
+
+    // The transcription grid starts at the first captured sample, 4 beats per bar.
+    const double beatLen = lastSampleRate * 60.0 / bpm;
+    const int clickLen = (int)clickNormal.size();
+    const int blockEnd = logicalStart + numSamples;
+
+    // start one click early: the previous one may still be ringing into this block
+    auto beat = juce::jmax<std::int64_t>(0, (std::int64_t)std::floor((logicalStart - clickLen) / beatLen));
+    for (;; ++beat)
+    {
+        const int clickStart = (int)std::llround((double)beat * beatLen);
+        if (clickStart >= blockEnd) break;
+
+        const auto& table = (beat % 4 == 0) ? clickAccent : clickNormal;
+        const int from = juce::jmax(logicalStart, clickStart);
+        const int to = juce::jmin(blockEnd, clickStart + juce::jmin(clickLen, (int)table.size()));
+        for (int i = from; i < to; ++i)
+            dst[i - logicalStart] += table[(size_t)(i - clickStart)];
+    }
 }
 
 
@@ -1,19 +1,37 @@
 #pragma once
 #include <JuceHeader.h>
 #include "EngineDefs.h"
+#include "WaveformPyramid.h"
+#include "SeedKey.h"
+#include "CandidateSearch.h"
+#include "SongForm.h"
+#include "DrumStyles.h"
+#include "BassStyleDB.h"
+#include "GenerationService.h"
+#include "VariationCache.h"
+#include "PatternLocks.h"
 #include <atomic>   // (at top of file if not already there)
 #include <cstdint>
 #include <functional>
 
 
 
-class BoomAudioProcessor : public juce::AudioProcessor
+class BoomAudioProcessor : public juce::AudioProcessor,
+                           private juce::Timer
 {
 public:
     BoomAudioProcessor();
     ~BoomAudioProcessor() override = default;
 
-    std::atomic<std::uint64_t> genNonce_{ 1 };
+    // ==== Seeds: every generator draws its randomness from a boom::seed::Key ====
+    // (session seed + engine + operation + running counter). Keep the key and the pattern can be rebuilt.
+    boom::seed::Key nextSeedKey(boom::seed::Op op);                 // advances the counter (or hands out a replay key)
+    int  nextSeed(boom::seed::Op op) { return nextSeedKey(op).toInt(); }
+    int  resolveSeed(int seed, boom::seed::Op op) { return seed >= 0 ? seed : nextSeed(op); } // -1 = derive
+    boom::seed::Key peekSeedKey(boom::seed::Op op) const;           // the key nextSeedKey(op) would hand out now
+    const boom::seed::Key& getLastSeedKey() const noexcept { return lastSeedKey; }
+    void replayNextWith(const boom::seed::Key& k) { replayKey = k; hasReplayKey = true; } // next draw reuses k exactly
+    std::uint32_t getSessionSeed() const noexcept;
 
     // ==== GEN: high-level generation entry points (engines) ====
 // 808 generator entry point (called from UI)
@@ -51,37 +69,11 @@ public:
     // Call when patterns change so the UI refreshes
     void notifyPatternChanged();
 
-    // Build a probability mask from the current kick pattern (row 0) at 16th-note resolution.
-// Returns a vector<int> length = bars*16, values in [0..100] = probability boost.
-    static std::vector<int> buildKickBiasMask(const BoomAudioProcessor& proc, int bars)
-    {
-        const int total16 = proc.q16(bars);
-        std::vector<int> bias(total16, 0);
-
-        const auto drums = proc.getDrumPattern();
-        for (const auto& n : drums)
-        {
-            if (n.row != 0) continue; // row 0 assumed = Kick
-            const int start16 = (n.startTick * 4) / BoomAudioProcessor::PPQ;
-            const int len16 = juce::jmax(1, (n.lengthTicks * 4) / BoomAudioProcessor::PPQ);
-            for (int s = 0; s < len16; ++s)
-            {
-                const int idx = start16 + s;
-                if ((unsigned)idx < bias.size())
-                    bias[idx] = juce::jlimit(0, 100, bias[idx] + juce::jmap(n.velocity, 1, 127, 15, 45));
-            }
-
-            // also nudge neighbors (so we "tend" toward kicks without being locked)
-            const int pre = start16 - 1;
-            const int pst = start16 + len16;
-            if (pre >= 0)              bias[pre] = juce::jmax(bias[pre], 12);
-            if (pst < (int)bias.size()) bias[pst] = juce::jmax(bias[pst], 12);
-        }
-
-        // tiny baseline so an empty kick lane still generates:
-        for (auto& b : bias) b = juce::jmax(b, 6);
-        return bias;
-    }
+    // ==== Cross-engine coupling: 808/Bass onsets lean toward (or away from) the kicks ====
+    // Kick bias per 16th in [0..1] from the current drum pattern (row 0). Cached, and rebuilt only
+    // after the drum pattern has changed, so generators can read it for free.
+    const std::vector<float>& getKickBias(int bars);
+    float getKickCoupling() const noexcept; // "kickCoupling": -1 avoid kicks .. 0 off .. +1 follow kicks
 
     // --- AI capture transport (playback + seek) ---
     void   aiPreviewStart();
@@ -91,7 +83,19 @@ public:
     bool   aiHasCapture() const noexcept { return captureLengthSamples > 0; }
     double getCaptureLengthSeconds() const noexcept;
     double getCapturePositionSeconds() const noexcept; // current preview read head in seconds
-    void   aiSeekToSeconds(double sec) noexcept;
+    void   aiSeekToSeconds(double sec) noexcept;       // queued; the audio thread applies it at block start
+
+    // Beat click layered over the preview (at the tempo of the last transcription) to check alignment by ear
+    void   aiSetPreviewClick(bool enabled) noexcept { previewClickEnabled.store(enabled); }
+    bool   aiIsPreviewClickEnabled() const noexcept { return previewClickEnabled.load(); }
+
+    // --- Waveform overview of the capture (message thread) ---
+    // aiUpdateWaveform folds whatever the audio thread wrote since the last call into the min/max pyramid;
+    // aiGetWaveformRange then answers a logical sample range (0..captureLength) without touching every sample.
+    struct CaptureOnset { int sample; int row; };   // logical sample + drum row (0 kick, 1 snare, 2 hat)
+    void   aiUpdateWaveform();
+    void   aiGetWaveformRange(int startSample, int endSample, float& mn, float& mx) const;
+    const std::vector<CaptureOnset>& aiGetCaptureOnsets() const noexcept { return captureOnsets; }
 
     // AudioProcessor
     void prepareToPlay(double sampleRate, int samplesPerBlock) override;
@@ -144,9 +148,76 @@ public:
 
 
     const Pattern& getDrumPattern() const noexcept { return drumPattern; }
+    std::uint32_t getDrumPatternVersion() const noexcept { return drumPatternVersion; } // bumps on every setDrumPattern
     const Pattern& getMelodicPattern() const noexcept { return melodicPattern; }
-    void setDrumPattern(const Pattern& p) { drumPattern = p; }
-    void setMelodicPattern(const Pattern& p) { melodicPattern = p; }
+    void setDrumPattern(const Pattern& p) { drumPattern = p; ++drumPatternVersion; drumForm.clear(); liveSeed[(int)boom::Engine::Drums] = -1; }
+    void setDrumPattern(Pattern&& p) { drumPattern = std::move(p); ++drumPatternVersion; drumForm.clear(); liveSeed[(int)boom::Engine::Drums] = -1; }
+    void setMelodicPattern(const Pattern& p) { melodicPattern = p; liveSeed[(int)boom::Engine::Bass] = liveSeed[(int)boom::Engine::e808] = -1; }
+
+    // ==== Long form (Drums): intro/verse/hook/bridge/outro sections over shared bar cells ====
+    // One take per section kind; later sections of a kind replay its cells. The drum pattern is set
+    // to the expanded song (the grid and edits use it, so the flat copy is held too); export reads the
+    // form. Any other edit of the pattern drops the form.
+    void generateDrumForm(boom::drums::StyleId style, int bars, int restPct, int dottedPct,
+        int tripletPct, int swingPct, int seed = -1);                  // -1 = next Generate seed key
+    const boom::form::Form<Note>& getDrumForm() const noexcept { return drumForm; }
+
+    // ==== Background generation ====
+    // The message thread snapshots everything a generator needs into a request (seed resolved,
+    // kick bias copied); a worker thread builds the pattern; the result is applied here on the
+    // message thread and reported through onGenerated. Rapid requests coalesce (only the newest
+    // runs) and a newer request cancels the running one.
+    struct GenRequest
+    {
+        boom::Engine engine = boom::Engine::Drums;   // Drums or Bass
+        juce::String style;                          // style name (drums or bass table)
+        int bars = 4, octave = 0;
+        int restPct = 0, dottedPct = 0, tripletPct = 0, swingPct = 0;
+        int seed = -1;                               // -1 = next Generate seed key
+        int candidates = 0;                          // Drums: > 1 keeps the best of this many by groove score
+        boom::PatternLocks locks;                    // kept regions (see Locks below); candidates are ignored while any is set
+    };
+    GenRequest makeGenRequest(boom::Engine engine) const;            // what Generate asks for with the current parameters
+    std::uint64_t requestGeneration(GenRequest request);             // 0 = served from the variation cache, already applied
+    void cancelGeneration() { generator.cancel(); }
+    bool isGenerating() const noexcept { return generator.isBusy(); }
+    std::function<void(boom::Engine)> onGenerated;   // message thread, after the result is applied
+
+    // ==== Variation cache: the next Generate / Dice takes, built before the click ====
+    // While enabled (the editor turns it on), a second worker keeps a few takes per engine ready for
+    // the seed keys the next clicks will draw. A take is tagged with the hash of the parameters it was
+    // built from and is only used while they still match, so it is exactly what generating on the
+    // click would have produced; the click just moves it into the pattern. Parameters are re-hashed
+    // on a 10 Hz timer, and a change drops the stale takes and restarts the refill.
+    void setVariationPrefetch(bool enabled);
+
+    // ==== Live regeneration: feel sliders re-run the last generate with its seed ====
+    // With "liveRegen" on, the editor calls this (debounced to one request per frame) while a feel
+    // slider moves. The generators are seed-stable, so only the slider's effect changes. Returns 0
+    // when the engine has nothing to re-run (no Drums / Bass take generated yet).
+    bool isLiveRegenerate() const noexcept;
+    std::uint64_t regenerateLive(boom::Engine engine);
+
+    // ==== Locks: rows / bars a Generate keeps ====
+    // Per engine (rows only mean something for Drums). Generate builds just the unlocked rows and
+    // bars and splices them into the pattern on screen, so re-rolling one lane costs one lane; Dice,
+    // 808, Rolls and Slapsmith keep the locked regions too. Set from the editors: shift-click a drum
+    // lane's label (row) or the top band of a bar in the drum grid / piano roll (bar).
+    const boom::PatternLocks& getLocks(boom::Engine engine) const noexcept { return locks[(int)engine]; }
+    void setRowLocked(boom::Engine engine, int row, bool locked) { locks[(int)engine].setRow(row, locked); }
+    void setBarLocked(boom::Engine engine, int bar, bool locked) { locks[(int)engine].setBar(bar, locked); }
+    void clearLocks(boom::Engine engine) { locks[(int)engine].clear(); }
+    int  getLockBarTicks(boom::Engine engine) const noexcept // bar length an engine's bar locks count in
+    {
+        if (engine != boom::Engine::Bass) return 4 * PPQ;   // drum grid and 808: 16 steps of 24 ticks
+        return getTimeSigNumerator() * (4 * PPQ / juce::jmax(1, getTimeSigDenominator()));
+    }
+
+    // ==== GEN: best-of-N (Drums) ====
+    // Builds 'count' drum candidates for the current style/feel on all cores and returns the 'topK'
+    // best by groove score (best first). Candidate i uses seed key.toInt(i) of one Generate key.
+    using DrumCandidate = boom::search::Candidate<Pattern>;
+    std::vector<DrumCandidate> generateDrumCandidates(int count, int topK, const boom::search::Targets& targets = {});
 
     const juce::StringArray& getDrumRows() const { return drumRows; }
 
@@ -170,13 +241,13 @@ public:
     // APVTS
 
     // === AI tools & generation wiring ===
-    void aiStyleBlendDrums(const juce::String& styleA, const juce::String& styleB, int bars, float wA, float wB);
+    void aiStyleBlendDrums(const juce::String& styleA, const juce::String& styleB, int bars, float wA, float wB, int seed = -1); // -1 = next seed key
     void aiSlapsmithExpand(int bars);
 
     // randomizes the currently-selected engines parameters (key/scale/bars/etc) & generates
     void randomizeCurrentEngine(int bars);
 
-    // rolls (drums only)  inject stylistic rolls/fills for 'bars' bars. seed = -1 uses random device
+    // rolls (drums only)  inject stylistic rolls/fills for 'bars' bars. seed = -1 uses the next Rolls seed key
     void generateRolls(const juce::String& style, int bars, int seed);
 
 
@@ -190,9 +261,26 @@ public:
     void aiStopCapture();
     bool aiIsCapturing() const { return isCapturing.load(); }
 
-    // Transcribe captured audio into a drum pattern (kick/snare/hat) for given bars/bpm
+    // Armed capture: recording starts on the next bar line of the host timeline (needs the transport running).
+    // loopBars > 0 loop-records: every pass of loopBars bars becomes one layer of the capture buffer.
+    void aiArmCapture(CaptureSource src, int loopBars = 0);
+    bool aiIsCaptureArmed() const noexcept { return captureArmed.load(); }
+    int  aiGetNumCaptureLayers() const noexcept { return captureLayersDone.load(); }
+    bool aiIsTranscribing() const noexcept { return transcriber.isBusy(); }
+
+    // Transcribe captured audio into a drum pattern (kick/snare/hat) for given bars/bpm.
+    // Runs on a background worker: the capture and the detection parameters are copied now, the
+    // pattern and the overview onsets land later and are reported through onGenerated(Drums).
     void aiAnalyzeCapturedToDrums(int bars, int bpm);
 
+    // Loop-record takes: one transcription per finished layer, kept so a take can be re-picked without
+    // recording again. Same worker as above; the takes are there once onGenerated(Drums) fires.
+    void aiAnalyzeCaptureLayers(int bars, int bpm);
+    int  aiGetNumLayerTakes() const noexcept { return (int)layerTakes.size(); }
+    int  aiGetBestLayer() const noexcept { return bestLayer; }         // pass that agrees most with the others, -1 = none
+    bool aiUseLayerTake(int layer);                                    // load one pass into the drum pattern
+    void aiUseConsensusTake(float minAgreement = 0.5f);                // keep hits found in at least this share of passes
+
     // 808 generator
     void generate808(const juce::String& style, const juce::String& keyName,
         const juce::String& scaleName, int bars,
@@ -213,17 +301,40 @@ public:
 
 private:
     Pattern drumPattern, melodicPattern;
+    boom::form::Form<Note> drumForm;   // empty unless the drum pattern came from generateDrumForm
+
+    // Pure builders shared by the synchronous entry points and the background worker: they read
+    // only their arguments, never the processor or the parameters.
+    static void buildDrumForm(const boom::drums::DrumStyleSpec& spec, int bars, int restPct, int dottedPct,
+        int tripletPct, int swingPct, std::uint32_t songSeed, boom::form::Form<Note>& form,
+        const std::function<bool()>& cancelled = {});
+    static void buildBassPattern(const boom::bass::StyleSpec& spec, int bars, int tsNum, int tsDen, int octave,
+        int restPct, int dottedPct, int tripletPct, int swingPct, int seed,
+        const std::vector<float>* kickBias, float coupling, Pattern& out,
+        const boom::PatternLocks* locks = nullptr);
+
+    // Kick bias cache (message thread): valid while kickBiasVersion == drumPatternVersion
+    std::uint32_t drumPatternVersion = 1, kickBiasVersion = 0;
+    std::vector<float> kickBias;
     juce::StringArray drumRows { boom::defaultDrumRows() };
 
     std::atomic<double> lastHostBpm { 120.0 };
 
+    // Seed state (message thread). The random session seed is only used while the "seed" param is 0,
+    // and is saved with the plugin state so reloading a session keeps its keys valid.
+    std::uint32_t randomSessionSeed = 0;
+    std::uint32_t seedCounter = 0;
+    boom::seed::Key lastSeedKey, replayKey;
+    bool hasReplayKey = false;
+
     std::atomic<float> rmsInputL { 0.0f }, rmsInputR{ 0.0f };
     std::atomic<int>   capturePlayheadSamples { 0 }; // advanced when recording
 
-    // ---- Random helpers (use juce::Random to avoid std::mt19937 headaches) ----
-    juce::Random prng;
-    int irand(int lo, int hi) { return prng.nextInt(juce::Range<int>(lo, hi + 1)); }
-    bool chance(int pct) { return prng.nextInt({ 0,100 }) < juce::jlimit(0, 100, pct); }
+    // ---- Random helpers (boom::Rng: same stream on every platform, see BoomRandom.h) ----
+    // Reseeded from a seed key at the start of every generator that uses it.
+    boom::Rng prng;
+    int irand(int lo, int hi) { return prng.range(lo, hi); }
+    bool chance(int pct) { return prng.chancePct(juce::jlimit(0, 100, pct)); }
 
     // ---- Quantize helpers ----
      // 96 ticks/quarter (we used this elsewhere)
@@ -247,13 +358,111 @@ private:
 
     void appendCaptureFrom(const juce::AudioBuffer<float>& in);
 
+    // --- Armed / loop-record state. captureLoopBars is set by the UI before the captureArmed
+    // release-store and only read after it; the layer sizes are published by the audio thread
+    // when the take starts on the bar line (and reset by the UI while no take runs). ---
+    std::atomic<bool>   captureArmed { false };
+    std::atomic<bool>   captureSynced { false };     // current take started on a bar line, ends with the transport
+    std::atomic<double> captureStartBpm { 0.0 };     // host tempo at the synced start (0 = free take)
+    int captureLoopBars = 0;                          // >0 = loop-record into layers of this many bars
+    std::atomic<int> captureLayerLen { 0 };           // samples per layer, fixed when the take starts
+    std::atomic<int> captureMaxLayers { 0 };          // layers that fit in the preallocated buffer
+    std::atomic<int> captureLayersDone { 0 };         // finished layers
+
+    std::atomic<juce::int64> captureTotalWritten { 0 }; // samples written this take (audio thread publishes)
+
+    boom::wave::MinMaxPyramid waveform;               // message thread only
+    juce::int64 waveformConsumed = 0;                 // captureTotalWritten already folded into 'waveform'
+    std::vector<CaptureOnset> captureOnsets;          // from the last transcription, for the overview
+
+    std::vector<Pattern> layerTakes;                  // per-pass transcriptions (message thread)
+    int layerTakeSteps = 0;                           // 16th steps per layer take
+    int bestLayer = -1;
+
     // --- Playback state for previewing the captured audio ---
     std::atomic<bool> isPreviewing { false };
-    int previewReadPos = 0;  // in samples, 0..captureLengthSamples
-
-    // Analysis helpers
-    Pattern transcribeAudioToDrums(const float* mono, int numSamples, int bars, int bpm) const;
+    std::atomic<int>  previewReadPos { 0 };       // logical samples, 0..captureLengthSamples (advanced by the audio thread)
+    std::atomic<int>  pendingPreviewSeek { -1 };  // seek target posted by the UI, -1 = none
+    int previewFadeFromPos = 0;                   // read head we crossfade away from after a seek
+    int previewFadeRemaining = 0;                 // samples left in that crossfade
+    int previewFadeLength = 256;                  // ~5 ms, set in prepareToPlay
+
+    std::atomic<bool> previewClickEnabled { false };
+    std::atomic<int>  previewGridBpm { 0 };       // tempo used by the last transcription (0 = follow host)
+    std::vector<float> clickNormal, clickAccent;  // pre-rendered click bursts, built in prepareToPlay
+
+    int  captureReadStart() const noexcept;       // physical index of logical sample 0 in the ring
+    template <typename Fn>
+    void forEachCaptureSpan(int logicalPos, int count, Fn&& fn) const;
+    void renderCapturePreview(juce::AudioBuffer<float>& out);
+    void addPreviewClicks(float* dst, int logicalStart, int numSamples) const;
+
+    // Analysis helpers. Transcription is pure (settings snapshotted on the message thread), so it
+    // runs on its own worker ('transcriber' below).
+    struct TranscribeSettings
+    {
+        double sampleRate = 44100.0;
+        bool hpss = false;                                 // "hpssEnabled"
+        float sensKick = 0.5f, sensSnare = 0.5f, sensHat = 0.5f; // "onsetSens*", 0..1
+    };
+    TranscribeSettings transcribeSettings() const;
+    static Pattern transcribeAudioToDrums(const float* mono, int numSamples, int bars, int bpm,
+                                          const TranscribeSettings& settings,
+                                          std::vector<CaptureOnset>* onsets = nullptr);
+    static int bestLayerOf(const std::vector<Pattern>& takes, int steps);
+    std::uint64_t requestTranscription(int bars, int bpm, bool consensus, bool layersOnly = false);
+    std::uint32_t captureTake = 0;                    // bumped when a take starts; stale transcriptions are dropped
+
+    // A finished transcription: the pattern (single take) or one take per loop pass, plus the onsets
+    struct Transcription
+    {
+        std::uint32_t captureTake = 0;
+        int gridBpm = 0;
+        Pattern pattern;
+        std::vector<CaptureOnset> onsets;            // logical samples, for the overview
+        std::vector<Pattern> layerTakes;
+        int layerTakeSteps = 0, bestLayer = -1;
+        bool useConsensus = false;
+    };
+    void applyTranscription(Transcription&& result);
 
+    // --- Background generation (last members: their workers stop before anything else goes away) ---
+    struct GenResult
+    {
+        boom::Engine engine = boom::Engine::Drums;
+        Pattern pattern;
+        boom::form::Form<Note> form;
+        int seed = -1;                               // the take's seed, for live regeneration
+        boom::PatternLocks locks;                    // regions left out of 'pattern': apply keeps the current notes there
+        int barTicks = 4 * PPQ;                      // bar length the locks are in
+    };
+    void applyGenerated(GenResult&& result);
+    int liveSeed[3] { -1, -1, -1 };                  // per boom::Engine: seed of the pattern on screen, -1 = none
+    boom::PatternLocks locks[3];                     // per boom::Engine (message thread)
+
+    // Variation cache (see setVariationPrefetch). Dice takes also carry the parameter values they rolled.
+    struct DicePicks { int styleIndex = -1, restPct = -1, dottedPct = -1, tripletPct = -1, swingPct = -1; }; // -1 = no such parameter
+    struct Variation { GenResult result; DicePicks picks; };
+    struct Prefetched { int slot = 0; std::uint64_t hash = 0; boom::seed::Key key; Variation take; };
+    enum VariationSlot { kVarDrums = 0, kVarBass, kVarDice, kNumVariationSlots };
+
+    using GenBuild = std::function<bool(const std::function<bool()>& cancelled, GenResult& out)>;
+    GenBuild makeGenBuild(const GenRequest& request, const boom::seed::Key& key); // snapshot now, run anywhere
+    static void buildDiceTake(const boom::seed::Key& key, const juce::StringArray& styles, std::uint8_t pctParams,
+        int bars, Variation& out);
+    std::uint8_t dicePctParams() const;          // bit i set: the i-th Dice density parameter exists
+    juce::StringArray diceStyleChoices() const;
+    std::uint64_t variationHash(const GenRequest& request) const;
+    std::uint64_t diceHash(int bars) const;
+    bool takeVariation(int slot, std::uint64_t hash, boom::seed::Op op, Variation& out);
+    void refillVariations();
+    void timerCallback() override { refillVariations(); }
+
+    std::array<boom::VariationRing<Variation>, kNumVariationSlots> variations;
+    bool prefetchEnabled = false;
+    boom::GenerationService<Prefetched> prefetcher;
+    boom::GenerationService<GenResult> generator;
+    boom::GenerationService<Transcription> transcriber; // separate worker: Generate / live regen never supersede a transcription
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(BoomAudioProcessor)
 };
\ No newline at end of file
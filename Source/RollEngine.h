@@ -0,0 +1,222 @@
+#pragma once
+#include <JuceHeader.h>
+#include <algorithm>
+#include <vector>
+#include "BoomRandom.h"
+#include "DrumStyles.h"
+#include "EngineDefs.h"
+
+// Rolls and fills from boom::StyleRules: hat rolls at the style's tick-level rates (24/12/8/6/4),
+// ghost snares before the backbeats, and snare or tom fills closing each phrase (phrase length from
+// varyEveryBars). Notes are placed at tick precision with linear velocity ramps, built bar by bar in
+// time order and merged into the caller's pattern snapshot in one pass.
+namespace boom::rolls
+{
+    using boom::drums::DrumNote;
+    using boom::drums::DrumPattern;
+
+    static constexpr int kTicksPer16 = 24;
+    static constexpr int kTicksPerBeat = 4 * kTicksPer16;
+    static constexpr int kBarTicks = 16 * kTicksPer16;
+
+    // 8 (1/16T) and 4 (1/32T) divide a 16th into a multiple of three
+    constexpr bool isTripletRate(int rate) noexcept { return rate > 0 && kTicksPer16 % rate == 0 && (kTicksPer16 / rate) % 3 == 0; }
+
+    // Time a roll covers on one row; plain notes of that row inside it give way to the roll
+    struct Span { int row, start, end; };
+
+    struct Result
+    {
+        DrumPattern notes;          // sorted by tick
+        std::vector<Span> spans;    // sorted by start within each row
+    };
+
+    inline void generate(const StyleRules& rules, int bars, int seed, Result& out)
+    {
+        out.notes.clearQuick();
+        out.spans.clear();
+        bars = juce::jlimit(1, 128, bars);
+
+        boom::Rng rng(static_cast<std::uint64_t>(static_cast<std::uint32_t>(seed)));
+
+        std::vector<int> rates;
+        for (int r : rules.hatRollRates) if (r > 0 && r <= kTicksPer16) rates.push_back(r);
+        if (rates.empty()) rates.push_back(kTicksPer16);
+        const int fastest = *std::min_element(rates.begin(), rates.end());
+
+        // A rate from the style list; triplet or straight by tripletHatProb, the fastest one more often when 'push'
+        auto pickRate = [&](bool push) -> int
+        {
+            const bool wantTriplet = rng.chancePct(rules.tripletHatProb);
+            int pool[8]; int n = 0;
+            for (int r : rates) if (isTripletRate(r) == wantTriplet && n < 8) pool[n++] = r;
+            if (n == 0) for (int r : rates) if (n < 8) pool[n++] = r;
+            if (push && rng.nextBool()) return *std::min_element(pool, pool + n);
+            return pool[rng.below(n)];
+        };
+
+        DrumPattern bar;
+        auto roll = [&](int row, int start, int rate, int count, int velFrom, int velTo)
+        {
+            for (int k = 0; k < count; ++k)
+            {
+                const int vel = count > 1 ? velFrom + (velTo - velFrom) * k / (count - 1) : velTo;
+                bar.add({ row, start + k * rate, rate, juce::jlimit(1, 127, vel) });
+            }
+            out.spans.push_back({ row, start, start + count * rate });
+        };
+
+        int phraseLen = 0, inPhrase = 0;
+        for (int b = 0; b < bars; ++b)
+        {
+            if (inPhrase == 0) phraseLen = juce::jmax(1, rng.range(rules.varyEveryBarsMin, rules.varyEveryBarsMax));
+            const bool phraseEnd = (inPhrase == phraseLen - 1) || (b == bars - 1);
+            inPhrase = phraseEnd ? 0 : inPhrase + 1;
+
+            bar.clearQuick();
+            const int barStart = b * kBarTicks;
+            const size_t spansBefore = out.spans.size();
+
+            // Ghost snares: one or two soft grace notes a 1/32 (or the style's fastest rate) ahead of the
+            // backbeats. Held back until the fill is known: a snare roll already covers its own beat.
+            DrumNote ghosts[16]; int numGhosts = 0;
+            for (int step : rules.snareBeats)
+            {
+                if (!rng.chancePct(rules.ghostSnareProb)) continue;
+                const int gap = juce::jmax(fastest, kTicksPer16 / 2);
+                const int count = rng.chancePct(30) ? 2 : 1;
+                for (int k = count; k >= 1; --k)
+                {
+                    const int t = step * kTicksPer16 - k * gap;
+                    if (t < 0) continue;
+                    const int vel = rng.range(35, 55);
+                    if (numGhosts < 16) ghosts[numGhosts++] = { boom::drums::Snare, barStart + t, gap, vel };
+                }
+            }
+
+            // Phrase-end fill on the last beat: toms (Perc row) by tomFillProb, otherwise a snare roll
+            bool fill = false;
+            if (phraseEnd)
+            {
+                const int start = barStart + 3 * kTicksPerBeat;
+                if (rng.chancePct(rules.tomFillProb))
+                {
+                    const int rate = fastest <= 12 ? 12 : kTicksPer16;
+                    roll(boom::drums::Perc, start, rate, kTicksPerBeat / rate, rng.range(80, 95), rng.range(112, 124));
+                    fill = true;
+                }
+                else if (rng.chancePct(50 + rules.ghostSnareProb))
+                {
+                    const int rate = juce::jmax(6, pickRate(true));
+                    roll(boom::drums::Snare, start, rate, kTicksPerBeat / rate, rng.range(55, 70), rng.range(105, 120));
+                    fill = true;
+                }
+            }
+
+            for (int g = 0; g < numGhosts; ++g)
+            {
+                const int t = ghosts[g].startTick;
+                bool covered = false, taken = false;
+                for (size_t s = spansBefore; s < out.spans.size(); ++s)
+                    covered = covered || (out.spans[s].row == boom::drums::Snare && out.spans[s].start <= t && t < out.spans[s].end);
+                for (int i = 0; i < g; ++i)
+                    taken = taken || ghosts[i].startTick == t;
+                if (!covered && !taken) bar.add(ghosts[g]);
+            }
+
+            // Hat rolls on beats or their "&"s; only where the style has rates finer than a 16th
+            if (fastest < kTicksPer16)
+            {
+                int hatEnd = barStart;
+                const int chance = phraseEnd ? 35 : 12;
+                for (int q = 0; q < (fill ? 3 : 4); ++q)
+                {
+                    if (!rng.chancePct(chance)) continue;
+                    const int start = barStart + q * kTicksPerBeat + (rng.nextBool() ? 0 : kTicksPerBeat / 2);
+                    if (start < hatEnd) continue;
+                    const int dur = (phraseEnd && start % kTicksPerBeat == 0 && q < 3 && rng.chancePct(30)) ? kTicksPerBeat : kTicksPerBeat / 2;
+                    const int rate = pickRate(phraseEnd);
+                    const int count = juce::jmin(16, dur / rate);
+                    int lo = rng.range(50, 65), hi = rng.range(90, 110);
+                    if (rng.chancePct(30)) std::swap(lo, hi);
+                    roll(boom::drums::ClosedHat, start, rate, count, lo, hi);
+                    hatEnd = start + count * rate;
+                }
+            }
+
+            // Bar notes in tick order (a handful of notes: insertion sort), then append
+            for (int i = 1; i < bar.size(); ++i)
+            {
+                const DrumNote n = bar.getReference(i);
+                int j = i;
+                for (; j > 0 && bar.getReference(j - 1).startTick > n.startTick; --j)
+                    bar.getReference(j) = bar.getReference(j - 1);
+                bar.getReference(j) = n;
+            }
+            for (const auto& n : bar) out.notes.add(n);
+
+            // Spans of this bar by start (fill and hats were pushed out of order)
+            std::sort(out.spans.begin() + (std::ptrdiff_t)spansBefore, out.spans.end(),
+                      [](const Span& x, const Span& y) { return x.start < y.start; });
+        }
+    }
+
+    // Merges the rolls into 'pattern' (the caller's snapshot, edited in place): notes of a rolled row
+    // inside a roll's span give way, everything else stays, a roll note never stacks on a kept note
+    // of its row at the same tick (ghosts before a backbeat), and the result is sorted by tick.
+    // NoteArray is the processor's pattern (row/startTick/lengthTicks/velocity).
+    template <typename NoteArray>
+    void mergeInto(NoteArray& pattern, const Result& rolls)
+    {
+        using Note = std::decay_t<decltype(pattern.getReference(0))>;
+        auto byTick = [](const Note& a, const Note& b) { return a.startTick < b.startTick; };
+        if (!std::is_sorted(pattern.begin(), pattern.end(), byTick))
+            std::stable_sort(pattern.begin(), pattern.end(), byTick);
+
+        // Drop covered notes in one sweep: spans and notes are both in time order
+        std::vector<size_t> next(boom::drums::NumRows, 0);
+        std::vector<std::vector<Span>> byRow(boom::drums::NumRows);
+        std::vector<std::vector<int>> keptTicks(boom::drums::NumRows); // per row, in time order
+        for (const auto& s : rolls.spans) byRow[(size_t)s.row].push_back(s);
+
+        int keep = 0;
+        for (int i = 0; i < pattern.size(); ++i)
+        {
+            const Note n = pattern.getReference(i);
+            bool covered = false;
+            if (n.row >= 0 && n.row < boom::drums::NumRows)
+            {
+                const auto& spans = byRow[(size_t)n.row];
+                auto& k = next[(size_t)n.row];
+                while (k < spans.size() && spans[k].end <= n.startTick) ++k;
+                covered = k < spans.size() && spans[k].start <= n.startTick;
+                if (!covered) keptTicks[(size_t)n.row].push_back(n.startTick);
+            }
+            if (!covered) pattern.getReference(keep++) = n;
+        }
+        pattern.removeRange(keep, pattern.size() - keep);
+
+        // Occupancy: the roll notes are in time order too, so one cursor per row finds same-tick notes
+        std::fill(next.begin(), next.end(), 0);
+        const int mid = pattern.size();
+        pattern.ensureStorageAllocated(mid + rolls.notes.size());
+        for (const auto& e : rolls.notes)
+        {
+            if (e.row >= 0 && e.row < boom::drums::NumRows)
+            {
+                const auto& ticks = keptTicks[(size_t)e.row];
+                auto& k = next[(size_t)e.row];
+                while (k < ticks.size() && ticks[k] < e.startTick) ++k;
+                if (k < ticks.size() && ticks[k] == e.startTick) continue;
+            }
+
+            Note n {};
+            n.row = e.row;
+            n.startTick = e.startTick;
+            n.lengthTicks = e.lenTicks;
+            n.velocity = e.vel;
+            pattern.add(n);
+        }
+        std::inplace_merge(pattern.begin(), pattern.begin() + mid, pattern.end(), byTick);
+    }
+}
@@ -0,0 +1,209 @@
+#pragma once
+#include <JuceHeader.h>
+#include <array>
+#include <cstdint>
+#include <initializer_list>
+
+// The one scale table. Each scale is a 12-bit pitch-class mask (bit i = i semitones above the
+// root), listed in the same order as the Scale choice parameter, so the parameter index IS the
+// scale id. Degree lists and the snap tables are derived from the masks at compile time: snapping
+// a pitch is one table read instead of a search, and there is nothing to keep in sync by hand.
+namespace boom::scale
+{
+    constexpr std::uint16_t maskOf(std::initializer_list<int> semis) noexcept
+    {
+        std::uint16_t m = 0;
+        for (int s : semis) m = (std::uint16_t)(m | (1u << (s % 12)));
+        return m;
+    }
+
+    struct ScaleDef
+    {
+        const char* name;
+        std::uint16_t mask;
+    };
+
+    inline constexpr ScaleDef kScales[] = {
+        { "Major",                   maskOf({ 0, 2, 4, 5, 7, 9, 11 }) },
+        { "Natural Minor",           maskOf({ 0, 2, 3, 5, 7, 8, 10 }) },
+        { "Harmonic Minor",          maskOf({ 0, 2, 3, 5, 7, 8, 11 }) },
+        { "Dorian",                  maskOf({ 0, 2, 3, 5, 7, 9, 10 }) },
+        { "Phrygian",                maskOf({ 0, 1, 3, 5, 7, 8, 10 }) },
+        { "Lydian",                  maskOf({ 0, 2, 4, 6, 7, 9, 11 }) },
+        { "Mixolydian",              maskOf({ 0, 2, 4, 5, 7, 9, 10 }) },
+        { "Aeolian",                 maskOf({ 0, 2, 3, 5, 7, 8, 10 }) },
+        { "Locrian",                 maskOf({ 0, 1, 3, 5, 6, 8, 10 }) },
+        { "Locrian Nat6",            maskOf({ 0, 1, 3, 5, 6, 9, 10 }) },
+        { "Ionian #5",               maskOf({ 0, 2, 4, 5, 8, 9, 11 }) },
+        { "Dorian #4",               maskOf({ 0, 2, 3, 6, 7, 9, 10 }) },
+        { "Phrygian Dom",            maskOf({ 0, 1, 4, 5, 7, 8, 10 }) },
+        { "Lydian #2",               maskOf({ 0, 3, 4, 6, 7, 9, 11 }) },
+        { "Super Locrian",           maskOf({ 0, 1, 3, 4, 6, 8, 10 }) },
+        { "Dorian b2",               maskOf({ 0, 1, 3, 5, 7, 9, 10 }) },
+        { "Lydian Aug",              maskOf({ 0, 2, 4, 6, 8, 9, 11 }) },
+        { "Lydian Dom",              maskOf({ 0, 2, 4, 6, 7, 9, 10 }) },
+        { "Mixo b6",                 maskOf({ 0, 2, 4, 5, 7, 8, 10 }) },
+        { "Locrian #2",              maskOf({ 0, 2, 3, 5, 6, 8, 10 }) },
+        { "8 Tone Spanish",          maskOf({ 0, 1, 3, 4, 5, 6, 8, 10 }) },
+        { "Phrygian Nat3",           maskOf({ 0, 1, 4, 5, 7, 8, 10 }) },
+        { "Blues",                   maskOf({ 0, 3, 5, 6, 7, 10 }) },
+        { "Hungarian Min",           maskOf({ 0, 2, 3, 6, 7, 8, 11 }) },
+        { "Harmonic Maj(Ethiopian)", maskOf({ 0, 2, 4, 5, 7, 8, 11 }) },
+        { "Dorian b5",               maskOf({ 0, 2, 3, 5, 6, 9, 10 }) },
+        { "Phrygian b4",             maskOf({ 0, 1, 3, 4, 7, 8, 10 }) },
+        { "Lydian b3",               maskOf({ 0, 2, 3, 6, 7, 9, 11 }) },
+        { "Mixolydian b2",           maskOf({ 0, 1, 4, 5, 7, 9, 10 }) },
+        { "Lydian Aug2",             maskOf({ 0, 3, 4, 6, 8, 9, 11 }) },
+        { "Locrian bb7",             maskOf({ 0, 1, 3, 5, 6, 8, 9 }) },
+        { "Pentatonic Maj",          maskOf({ 0, 2, 4, 7, 9 }) },
+        { "Pentatonic Min",          maskOf({ 0, 3, 5, 7, 10 }) },
+        { "Neopolitan Maj",          maskOf({ 0, 1, 3, 5, 7, 9, 11 }) },
+        { "Neopolitan Min",          maskOf({ 0, 1, 3, 5, 7, 8, 11 }) },
+        { "Spanish Gypsy",           maskOf({ 0, 1, 4, 5, 7, 8, 10 }) },
+        { "Romanian Minor",          maskOf({ 0, 2, 3, 6, 7, 9, 10 }) },
+        { "Chromatic",               maskOf({ 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11 }) },
+        { "Bebop Major",             maskOf({ 0, 2, 4, 5, 7, 8, 9, 11 }) },
+        { "Bebop Minor",             maskOf({ 0, 2, 3, 5, 7, 8, 9, 10 }) },
+    };
+
+    inline constexpr int kNumScales = (int)(sizeof(kScales) / sizeof(kScales[0]));
+    inline constexpr int kMajor = 0;
+    inline constexpr int kChromatic = 37;
+
+    constexpr int wrap12(int v) noexcept { v %= 12; return v < 0 ? v + 12 : v; }
+    constexpr int clampId(int id) noexcept { return (id >= 0 && id < kNumScales) ? id : kChromatic; }
+
+    // ---- Derived tables (compile time) ----
+    struct Tables
+    {
+        std::uint8_t count[kNumScales] {};          // notes per octave
+        std::uint8_t degree[kNumScales][12] {};     // degree -> semitones above root
+        std::int8_t  nearest[kNumScales][12] {};    // [scale][interval] -> offset to the nearest scale tone (ties go up)
+        std::int8_t  below[kNumScales][12] {};      // [scale][interval] -> offset (<= 0) to the scale tone at or below
+    };
+
+    constexpr Tables buildTables() noexcept
+    {
+        Tables t {};
+        for (int s = 0; s < kNumScales; ++s)
+        {
+            const unsigned m = kScales[s].mask;
+            int n = 0;
+            for (int i = 0; i < 12; ++i)
+                if (m & (1u << i)) t.degree[s][n++] = (std::uint8_t)i;
+            t.count[s] = (std::uint8_t)n;
+
+            for (int iv = 0; iv < 12; ++iv)
+            {
+                int d = 0;
+                while (d < 12 && !(m & (1u << wrap12(iv - d)))) ++d;
+                t.below[s][iv] = (std::int8_t)-d;
+
+                int off = 0;
+                for (d = 0; d <= 6; ++d)
+                {
+                    if (m & (1u << wrap12(iv + d))) { off = d; break; }
+                    if (m & (1u << wrap12(iv - d))) { off = -d; break; }
+                }
+                t.nearest[s][iv] = (std::int8_t)off;
+            }
+        }
+        return t;
+    }
+
+    inline constexpr Tables kTables = buildTables();
+
+    // ---- Queries ----
+    constexpr int size(int id) noexcept { return kTables.count[clampId(id)]; }
+
+    // Semitones above the root for a degree; degrees wrap within the octave
+    constexpr int interval(int id, int degree) noexcept
+    {
+        id = clampId(id);
+        const int n = kTables.count[id];
+        return kTables.degree[id][((degree % n) + n) % n];
+    }
+
+    // Degree -> MIDI note relative to rootMidi; degrees past the end carry into the next octave
+    constexpr int degreeToMidi(int id, int rootMidi, int degree) noexcept
+    {
+        const int n = size(id);
+        const int oct = degree >= 0 ? degree / n : -((n - 1 - degree) / n);
+        return rootMidi + 12 * oct + interval(id, degree - oct * n);
+    }
+
+    constexpr bool contains(int id, int rootPC, int midi) noexcept
+    {
+        return (kScales[clampId(id)].mask >> wrap12(midi - rootPC)) & 1u;
+    }
+
+    // Nearest pitch of (root + scale); an equal distance up or down goes up
+    constexpr int snap(int midi, int rootPC, int id) noexcept
+    {
+        return midi + kTables.nearest[clampId(id)][wrap12(midi - rootPC)];
+    }
+
+    // Highest pitch of (root + scale) at or below midi
+    constexpr int snapDown(int midi, int rootPC, int id) noexcept
+    {
+        return midi + kTables.below[clampId(id)][wrap12(midi - rootPC)];
+    }
+
+    // Scale id from a display name (case and surrounding spaces ignored), or -1
+    inline int indexOf(const juce::String& name)
+    {
+        const auto n = name.trim();
+        for (int i = 0; i < kNumScales; ++i)
+            if (n.equalsIgnoreCase(kScales[i].name)) return i;
+        return -1;
+    }
+
+    inline int fromName(const juce::String& name, int fallback = kChromatic)
+    {
+        const int i = indexOf(name);
+        return i >= 0 ? i : fallback;
+    }
+
+    // Build-time checks in place of a test target: the table matches the Scale parameter
+    // (scaleChoices() is built from it, so every UI name resolves by construction), names are
+    // unique, every scale contains its root, and the snap tables always land in the scale.
+    namespace detail
+    {
+        constexpr bool sameName(const char* a, const char* b) noexcept
+        {
+            while (*a && *a == *b) { ++a; ++b; }
+            return *a == *b;
+        }
+
+        constexpr bool namesUnique() noexcept
+        {
+            for (int i = 0; i < kNumScales; ++i)
+                for (int j = i + 1; j < kNumScales; ++j)
+                    if (sameName(kScales[i].name, kScales[j].name)) return false;
+            return true;
+        }
+
+        constexpr bool snapsLandInScale() noexcept
+        {
+            for (int s = 0; s < kNumScales; ++s)
+            {
+                if (!(kScales[s].mask & 1u) || size(s) < 5) return false;
+                for (int root = 0; root < 12; ++root)
+                    for (int midi = 48; midi < 60; ++midi)
+                    {
+                        const int up = snap(midi, root, s), down = snapDown(midi, root, s);
+                        if (!contains(s, root, up) || !contains(s, root, down) || down > midi) return false;
+                        if (contains(s, root, midi) && (up != midi || down != midi)) return false;
+                    }
+            }
+            return true;
+        }
+    }
+
+    static_assert(kNumScales == 40, "scale table must match the Scale parameter");
+    static_assert(detail::sameName(kScales[kChromatic].name, "Chromatic") && kScales[kChromatic].mask == 0xFFF, "kChromatic index");
+    static_assert(detail::namesUnique(), "duplicate scale name");
+    static_assert(detail::snapsLandInScale(), "scale snap tables broken");
+    static_assert(snap(61, 0, kMajor) == 62 && snap(66, 0, kMajor) == 67 && snap(63, 2, 1) == 64, "snap ties go up");
+    static_assert(degreeToMidi(kMajor, 60, 7) == 72 && degreeToMidi(kMajor, 60, -1) == 59, "degree octave carry");
+}
@@ -0,0 +1,76 @@
+#pragma once
+#include <JuceHeader.h>
+#include <cstdint>
+#include "BoomRandom.h"
+
+// One seed-derivation scheme for every generator: a small Key (session seed + engine + operation +
+// running counter) hashes to the random stream, so a pattern can be rebuilt bit-exactly from its key
+// instead of storing the notes.
+namespace boom::seed
+{
+    // What the randomness is for; part of the key so a flip and a generate on the same counter differ
+    enum class Op : std::uint8_t
+    {
+        Generate = 0,
+        Flip,
+        Rolls,
+        StyleBlend,
+        Slapsmith,
+        Randomize,
+        Variation,
+        NumOps
+    };
+
+    using boom::splitmix64;
+
+    struct Key
+    {
+        std::uint32_t session = 0;
+        std::uint8_t  engine = 0;          // boom::Engine
+        Op            op = Op::Generate;
+        std::uint32_t counter = 0;         // low 24 bits kept
+
+        // session(32) | engine(4) | op(4) | counter(24)
+        constexpr std::uint64_t pack() const noexcept
+        {
+            return ((std::uint64_t)session << 32)
+                 | ((std::uint64_t)(engine & 0x0Fu) << 28)
+                 | ((std::uint64_t)((std::uint8_t)op & 0x0Fu) << 24)
+                 | (std::uint64_t)(counter & 0xFFFFFFu);
+        }
+
+        static constexpr Key unpack(std::uint64_t v) noexcept
+        {
+            Key k;
+            k.session = (std::uint32_t)(v >> 32);
+            k.engine = (std::uint8_t)((v >> 28) & 0x0Fu);
+            k.op = (Op)((v >> 24) & 0x0Fu);
+            k.counter = (std::uint32_t)(v & 0xFFFFFFu);
+            return k;
+        }
+
+        // 64-bit stream seed; 'salt' picks an independent sub-stream inside one generation
+        constexpr std::uint64_t derive(std::uint64_t salt = 0) const noexcept
+        {
+            return splitmix64(splitmix64(pack()) ^ splitmix64(salt + 0x632BE59BD9B4E019ull));
+        }
+
+        // Non-negative 31-bit form for APIs that take an int seed (the style generators, Flippit)
+        constexpr int toInt(std::uint64_t salt = 0) const noexcept { return (int)(derive(salt) & 0x7FFFFFFFu); }
+
+        // Ready-to-use generator for this key
+        constexpr Rng rng(std::uint64_t salt = 0) const noexcept { return Rng(derive(salt)); }
+
+        juce::String toString() const { return juce::String::toHexString((juce::int64)pack()).paddedLeft('0', 16); }
+
+        static Key fromString(const juce::String& hex) { return unpack((std::uint64_t)hex.getHexValue64()); }
+
+        constexpr bool operator== (const Key& o) const noexcept { return pack() == o.pack(); }
+        constexpr bool operator!= (const Key& o) const noexcept { return pack() != o.pack(); }
+    };
+
+    // Same key, same stream: the whole point of the scheme
+    static_assert(Key{ 7, 2, Op::Flip, 3 }.derive() == Key::unpack(Key{ 7, 2, Op::Flip, 3 }.pack()).derive(), "key must round-trip");
+    static_assert(Key{ 7, 2, Op::Flip, 3 }.derive() != Key{ 7, 2, Op::Flip, 4 }.derive(), "counter must change the stream");
+    static_assert(Key{ 7, 2, Op::Flip, 3 }.derive() != Key{ 7, 2, Op::Rolls, 3 }.derive(), "op must change the stream");
+}
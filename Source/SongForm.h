@@ -0,0 +1,140 @@
+#pragma once
+#include <JuceHeader.h>
+#include <cstdint>
+#include <vector>
+
+// Long arrangements as a section list over shared bar cells. A cell is one unique bar of notes
+// (bar-relative ticks, sorted); a section is a run of bars, each naming the cell it plays. Sections
+// of the same kind share their cells and identical bars collapse into one cell, so generation scales
+// with the unique bars rather than the song length, and MIDI export walks the sections (forEachNote).
+// The grid and every pattern edit still work on the flat pattern (expand), which the processor keeps
+// next to the form: memory for a long song is the flat copy plus the cells.
+namespace boom::form
+{
+    enum class Kind : std::uint8_t { Intro = 0, Verse, Hook, Bridge, Outro, NumKinds };
+
+    inline const char* kindName(Kind k) noexcept
+    {
+        static constexpr const char* names[] = { "Intro", "Verse", "Hook", "Bridge", "Outro" };
+        return names[juce::jlimit(0, (int)Kind::NumKinds - 1, (int)k)];
+    }
+
+    struct Section
+    {
+        Kind kind = Kind::Verse;
+        int bars = 0;
+    };
+
+    // Song layout for 'totalBars' bars. Up to 8 bars is a single verse; longer forms get a 4-bar
+    // intro and outro around verse / hook / bridge sections of 8 bars (16 from 56 bars of body).
+    inline void layout(int totalBars, std::vector<Section>& out)
+    {
+        out.clear();
+        totalBars = juce::jmax(1, totalBars);
+        if (totalBars <= 8) { out.push_back({ Kind::Verse, totalBars }); return; }
+
+        const int edge = 4;
+        int body = totalBars - 2 * edge;
+        const int len = body >= 56 ? 16 : 8;
+        static constexpr Kind cycle[] = { Kind::Verse, Kind::Hook, Kind::Verse, Kind::Hook, Kind::Bridge, Kind::Hook };
+
+        out.push_back({ Kind::Intro, edge });
+        for (int i = 0; body > 0; ++i)
+        {
+            const int n = juce::jmin(len, body);
+            if (n < edge && out.size() > 1) out.back().bars += n; // a short tail joins the last section
+            else out.push_back({ cycle[i % (int)std::size(cycle)], n });
+            body -= n;
+        }
+        out.push_back({ Kind::Outro, edge });
+    }
+
+    // NoteT is the processor's note (row/pitch/startTick/lengthTicks/velocity)
+    template <typename NoteT>
+    struct Form
+    {
+        using Bar = juce::Array<NoteT>;
+
+        struct Placed
+        {
+            Section section;
+            std::vector<int> cells;     // one cell index per bar of the section
+        };
+
+        int barTicks = 384;
+        std::vector<Bar> cells;
+        std::vector<Placed> sections;  // song order
+
+        bool empty() const noexcept { return sections.empty(); }
+        void clear() { cells.clear(); sections.clear(); }
+
+        int totalBars() const noexcept
+        {
+            int n = 0;
+            for (const auto& s : sections) n += s.section.bars;
+            return n;
+        }
+
+        // Index of a cell holding exactly these notes, adding one if none does
+        int addCell(Bar&& bar)
+        {
+            for (size_t i = 0; i < cells.size(); ++i)
+                if (sameBar(cells[i], bar)) return (int)i;
+            cells.push_back(std::move(bar));
+            return (int)cells.size() - 1;
+        }
+
+        // fn(note, absoluteStartTick) for every note starting in [fromTick, toTick), in time order.
+        // Only the bars overlapping the range are visited.
+        template <typename Fn>
+        void forEachNote(int fromTick, int toTick, Fn&& fn) const
+        {
+            int barStart = 0;
+            for (const auto& s : sections)
+            {
+                for (int cell : s.cells)
+                {
+                    if (barStart >= toTick) return;
+                    if (barStart + barTicks > fromTick)
+                        for (const auto& n : cells[(size_t)cell])
+                        {
+                            const int t = barStart + n.startTick;
+                            if (t >= fromTick && t < toTick) fn(n, t);
+                        }
+                    barStart += barTicks;
+                }
+            }
+        }
+
+        // The whole song as one flat pattern
+        void expand(juce::Array<NoteT>& out) const
+        {
+            out.clearQuick();
+            int total = 0;
+            for (const auto& s : sections)
+                for (int cell : s.cells) total += cells[(size_t)cell].size();
+            out.ensureStorageAllocated(total);
+
+            forEachNote(0, totalBars() * barTicks, [&](const NoteT& n, int t)
+            {
+                NoteT c = n;
+                c.startTick = t;
+                out.add(c);
+            });
+        }
+
+    private:
+        static bool sameBar(const Bar& a, const Bar& b)
+        {
+            if (a.size() != b.size()) return false;
+            for (int i = 0; i < a.size(); ++i)
+            {
+                const auto& x = a.getReference(i);
+                const auto& y = b.getReference(i);
+                if (x.row != y.row || x.pitch != y.pitch || x.startTick != y.startTick
+                    || x.lengthTicks != y.lengthTicks || x.velocity != y.velocity) return false;
+            }
+            return true;
+        }
+    };
+}
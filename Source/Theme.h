@@ -69,6 +69,15 @@ namespace boomtheme
     inline juce::Colour LightAccent()       { return juce::Colour::fromString("FFC9D2A7"); }
     inline juce::Colour NoteFill()          { return juce::Colour::fromString("FF7CD400"); }
     inline juce::Colour PanelStroke()       { return juce::Colour::fromString("FF3A1484"); }
+    inline juce::Colour WaveformFill()      { return juce::Colour::fromString("FFC9D2A7"); }
+
+    // Marker colour per drum row (kick, snare, hat, then the rest), e.g. onsets over the capture waveform
+    inline juce::Colour DrumRowColour(int row)
+    {
+        static const juce::uint32 argb[] = { 0xFFFF5A36, 0xFFFFD23F, 0xFF3FD3FF, 0xFF8E6BFF, 0xFFFF4FD8, 0xFFFFFFFF };
+        const int n = (int)(sizeof(argb) / sizeof(argb[0]));
+        return juce::Colour(argb[((row % n) + n) % n]);
+    }
 
     inline void drawPanel(juce::Graphics& g, juce::Rectangle<float> r, float radius = 12.f)
     {
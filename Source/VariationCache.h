@@ -0,0 +1,89 @@
+#pragma once
+#include <JuceHeader.h>
+#include <array>
+#include <cstdint>
+#include "SeedKey.h"
+
+namespace boom
+{
+    // A few ready-made takes for the next clicks of one generator, oldest first. Every take is
+    // built for a known seed key (consecutive counters) from a request whose parameters hash to
+    // hash(); the owner resets the ring when that hash changes and only hands out the take whose
+    // key is the one the click is about to draw. Message thread only.
+    template <typename Take, int Capacity = 4>
+    class VariationRing
+    {
+    public:
+        std::uint64_t hash() const noexcept { return paramHash; }
+        int  size() const noexcept { return count; }
+        bool empty() const noexcept { return count == 0; }
+        bool full() const noexcept { return count == Capacity; }
+
+        // New parameters: everything built for the old ones is dropped
+        void reset(std::uint64_t newHash)
+        {
+            for (auto& e : entries) e = Entry {};
+            head = count = 0;
+            paramHash = newHash;
+        }
+
+        // Key the next take should be built for: the counter after the newest one
+        seed::Key nextKey() const noexcept
+        {
+            jassert(count > 0);
+            seed::Key k = at(count - 1).key;
+            k.counter = (k.counter + 1) & 0xFFFFFFu;
+            return k;
+        }
+
+        // Drops takes from the front until the oldest is the one for 'k' (all of them if none is)
+        void dropUntil(const seed::Key& k)
+        {
+            while (count > 0 && at(0).key != k) popFront();
+        }
+
+        void push(const seed::Key& k, Take&& take)
+        {
+            if (full()) return;
+            auto& e = entries[(size_t)((head + count) % Capacity)];
+            e.key = k;
+            e.take = std::move(take);
+            ++count;
+        }
+
+        // Moves out the take built for exactly 'k' and drops the older ones. False (ring untouched)
+        // when no take has that key.
+        bool take(const seed::Key& k, Take& out)
+        {
+            for (int i = 0; i < count; ++i)
+            {
+                if (at(i).key != k) continue;
+                out = std::move(at(i).take);
+                for (int d = 0; d <= i; ++d) popFront();
+                return true;
+            }
+            return false;
+        }
+
+    private:
+        struct Entry
+        {
+            seed::Key key;
+            Take take {};
+        };
+
+        Entry& at(int i) noexcept { return entries[(size_t)((head + i) % Capacity)]; }
+        const Entry& at(int i) const noexcept { return entries[(size_t)((head + i) % Capacity)]; }
+
+        void popFront()
+        {
+            at(0) = Entry {};   // release the notes now, not when the slot is reused
+            head = (head + 1) % Capacity;
+            --count;
+        }
+
+        std::array<Entry, (size_t)Capacity> entries {};
+        int head = 0, count = 0;
+        std::uint64_t paramHash = 0;
+    };
+}
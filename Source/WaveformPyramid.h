@@ -0,0 +1,111 @@
+#pragma once
+#include <JuceHeader.h>
+#include <vector>
+
+namespace boom::wave
+{
+    // Multi-resolution min/max summary of the capture buffer. Level 0 holds one (min,max) bin per
+    // kBaseBlock samples, every level above halves the bin count, so any range can be answered from
+    // a handful of bins plus at most two partial blocks of raw samples. Indices are the same as the
+    // capture buffer's (physical) sample indices.
+    class MinMaxPyramid
+    {
+    public:
+        static constexpr int kBaseBlock = 64;
+
+        void reset(int capacitySamples)
+        {
+            capacity = juce::jmax(0, capacitySamples);
+            levels.clear();
+
+            int bins = (capacity + kBaseBlock - 1) / kBaseBlock;
+            while (bins > 0)
+            {
+                levels.push_back({ std::vector<float>((size_t)bins, 0.0f), std::vector<float>((size_t)bins, 0.0f) });
+                if (bins == 1) break;
+                bins = (bins + 1) / 2;
+            }
+        }
+
+        int getCapacity() const noexcept { return capacity; }
+
+        // Fold freshly written samples [start, end) of 'data' into every level.
+        // Only the bins touching that range (and their parents) are recomputed.
+        void update(const float* data, int start, int end)
+        {
+            start = juce::jlimit(0, capacity, start);
+            end = juce::jlimit(0, capacity, end);
+            if (levels.empty() || data == nullptr || start >= end) return;
+
+            int lo = start / kBaseBlock, hi = (end - 1) / kBaseBlock;
+            for (int b = lo; b <= hi; ++b)
+            {
+                // The last bin stops at 'end' so stale samples from an older lap don't leak in
+                const int s = b * kBaseBlock;
+                const int e = (b == hi) ? end : juce::jmin(capacity, s + kBaseBlock);
+                float mn = data[s], mx = data[s];
+                for (int i = s + 1; i < e; ++i)
+                {
+                    mn = juce::jmin(mn, data[i]);
+                    mx = juce::jmax(mx, data[i]);
+                }
+                levels[0].mn[(size_t)b] = mn;
+                levels[0].mx[(size_t)b] = mx;
+            }
+
+            for (size_t L = 1; L < levels.size(); ++L)
+            {
+                lo >>= 1; hi >>= 1;
+                const auto& child = levels[L - 1];
+                auto& lvl = levels[L];
+                for (int b = lo; b <= hi; ++b)
+                {
+                    const size_t c0 = (size_t)b * 2, c1 = c0 + 1;
+                    const bool hasSecond = c1 < child.mn.size();
+                    lvl.mn[(size_t)b] = hasSecond ? juce::jmin(child.mn[c0], child.mn[c1]) : child.mn[c0];
+                    lvl.mx[(size_t)b] = hasSecond ? juce::jmax(child.mx[c0], child.mx[c1]) : child.mx[c0];
+                }
+            }
+        }
+
+        // Exact min/max of samples [start, end): raw samples for the unaligned edges,
+        // then whole bins climbed bottom-up like a segment tree (O(kBaseBlock + log n)).
+        void query(const float* data, int start, int end, float& mn, float& mx) const
+        {
+            mn = 0.0f; mx = 0.0f;
+            start = juce::jlimit(0, capacity, start);
+            end = juce::jlimit(0, capacity, end);
+            if (levels.empty() || data == nullptr || start >= end) return;
+
+            mn = data[start]; mx = data[start];
+            auto takeRaw = [&](int s, int e)
+            {
+                for (int i = s; i < e; ++i) { mn = juce::jmin(mn, data[i]); mx = juce::jmax(mx, data[i]); }
+            };
+
+            int l = (start + kBaseBlock - 1) / kBaseBlock;
+            int r = end / kBaseBlock;
+            if (l >= r)
+            {
+                takeRaw(start, end);
+                return;
+            }
+
+            takeRaw(start, l * kBaseBlock);
+            takeRaw(r * kBaseBlock, end);
+
+            for (size_t L = 0; L < levels.size() && l < r; ++L)
+            {
+                const auto& lvl = levels[L];
+                if (l & 1) { mn = juce::jmin(mn, lvl.mn[(size_t)l]); mx = juce::jmax(mx, lvl.mx[(size_t)l]); ++l; }
+                if (r & 1) { --r; mn = juce::jmin(mn, lvl.mn[(size_t)r]); mx = juce::jmax(mx, lvl.mx[(size_t)r]); }
+                l >>= 1; r >>= 1;
+            }
+        }
+
+    private:
+        struct Level { std::vector<float> mn, mx; };
+        std::vector<Level> levels;
+        int capacity = 0;
+    };
+}
@@ -0,0 +1,146 @@
+#pragma once
+#include <JuceHeader.h>
+#include <array>
+#include <cstdint>
+#include "BoomRandom.h"
+
+namespace boom
+{
+    // Weighted draw without replacement over up to Capacity slots, backed by a Fenwick tree.
+    // Weights are stored as 16.16 fixed point, so the running total is an exact integer: removing
+    // a slot subtracts exactly what it added and the sums never drift (the old float scan slowly
+    // lost weight and fell back to "first free slot"). Build is O(n), draw and remove are O(log n).
+    template <int Capacity>
+    class WeightedSampler
+    {
+    public:
+        static_assert(Capacity > 0, "sampler needs at least one slot");
+
+        static constexpr std::uint64_t kOne = 1ull << 16;
+
+        // Weights below 1/65536 (and negatives) count as zero: that slot is never drawn
+        static constexpr std::uint64_t quantize(float w) noexcept
+        {
+            return w > 0.0f ? (std::uint64_t)((double)w * (double)kOne + 0.5) : 0ull;
+        }
+
+        constexpr WeightedSampler() noexcept = default;
+
+        // weightAt(i) -> float for i in [0, n); n is clamped to Capacity
+        template <typename Get>
+        constexpr void build(int n, Get&& weightAt) noexcept
+        {
+            size = n < 0 ? 0 : (n > Capacity ? Capacity : n);
+            sum = 0;
+            tree[0] = 0;
+            for (int i = 1; i <= size; ++i)
+            {
+                weight[(size_t)i] = quantize((float)weightAt(i - 1));
+                tree[(size_t)i] = weight[(size_t)i];
+                sum += weight[(size_t)i];
+            }
+            // Linear Fenwick construction: push each node into its parent once
+            for (int i = 1; i <= size; ++i)
+            {
+                const int parent = i + (i & -i);
+                if (parent <= size) tree[(size_t)parent] += tree[(size_t)i];
+            }
+        }
+
+        constexpr int numSlots() const noexcept { return size; }
+        constexpr std::uint64_t total() const noexcept { return sum; }
+        constexpr bool empty() const noexcept { return sum == 0; }
+        constexpr std::uint64_t weightOf(int i) const noexcept { return (i >= 0 && i < size) ? weight[(size_t)i + 1] : 0ull; }
+
+        // Slot index with probability weight / total, or -1 once every weighted slot is gone
+        constexpr int draw(Rng& rng) const noexcept
+        {
+            if (sum == 0) return -1;
+            std::uint64_t r = rng.below64(sum);
+
+            // Descend: find the first slot whose prefix sum exceeds r
+            int pos = 0;
+            int step = 1;
+            while (step * 2 <= size) step *= 2;
+            for (; step > 0; step /= 2)
+            {
+                const int next = pos + step;
+                if (next <= size && tree[(size_t)next] <= r)
+                {
+                    pos = next;
+                    r -= tree[(size_t)next];
+                }
+            }
+            return pos; // prefix(pos) <= r < prefix(pos + 1): 1-based slot pos + 1, i.e. index pos
+        }
+
+        constexpr void remove(int i) noexcept
+        {
+            if (i < 0 || i >= size) return;
+            const std::uint64_t w = weight[(size_t)i + 1];
+            if (w == 0) return;
+            weight[(size_t)i + 1] = 0;
+            sum -= w;
+            for (int k = i + 1; k <= size; k += (k & -k))
+                tree[(size_t)k] -= w;
+        }
+
+        // draw() + remove() in one go
+        constexpr int take(Rng& rng) noexcept
+        {
+            const int i = draw(rng);
+            remove(i);
+            return i;
+        }
+
+    private:
+        std::array<std::uint64_t, (size_t)Capacity + 1> tree {};
+        std::array<std::uint64_t, (size_t)Capacity + 1> weight {};
+        int size = 0;
+        std::uint64_t sum = 0;
+    };
+
+    // Build-time checks in place of a test target: frequencies follow the weights (chi-square on a
+    // fixed seed), removed slots never come back, and zero-weight slots are never drawn.
+    namespace detail
+    {
+        constexpr double samplerChiSquare()
+        {
+            constexpr float w[] = { 1.0f, 2.0f, 0.0f, 3.0f, 4.0f };
+            WeightedSampler<5> s;
+            s.build(5, [&](int i) { return w[i]; });
+            Rng rng(2024);
+            int hits[5] = { 0, 0, 0, 0, 0 };
+            constexpr int draws = 1000;
+            for (int k = 0; k < draws; ++k) ++hits[s.draw(rng)];
+            if (hits[2] != 0) return 1.0e9;
+
+            double chi = 0.0;
+            for (int i = 0; i < 5; ++i)
+                if (w[i] > 0.0f)
+                {
+                    const double expect = draws * (double)w[i] / 10.0;
+                    chi += (hits[i] - expect) * (hits[i] - expect) / expect;
+                }
+            return chi;
+        }
+
+        constexpr bool samplerRemoval()
+        {
+            WeightedSampler<9> s;
+            s.build(9, [](int i) { return i == 4 ? 0.0f : 0.5f + (float)i; });
+            Rng rng(5);
+            bool seen[9] = {};
+            for (int k = 0; k < 8; ++k)
+            {
+                const int i = s.take(rng);
+                if (i < 0 || i == 4 || seen[i]) return false;
+                seen[i] = true;
+            }
+            return s.empty() && s.take(rng) == -1;
+        }
+    }
+    // 3 degrees of freedom: 16.27 is the p = 0.001 critical value
+    static_assert(detail::samplerChiSquare() < 16.27, "WeightedSampler frequencies don't follow the weights");
+    static_assert(detail::samplerRemoval(), "WeightedSampler removal broken");
+}